@@ -0,0 +1,196 @@
+/*
+ * File:   CSarq.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * getFile and the telemetry stream send their data strictly in order from an offset kept in csStreamState,
+ * so a frame lost on a bad pass meant asking for everything again from the lost frame on. With selective
+ * repeat the stream is cut into numbered chunks and only the ones the ground didn't get are sent again:
+ *
+ * - Chunk n holds the ARQ_CHUNK_BYTES bytes at offset + n * ARQ_CHUNK_BYTES of the open file, behind its
+ *   sequence number, so any chunk can be read again from the handle and nothing has to be kept for resending.
+ * - At most ARQ_WINDOW chunks past the oldest one the ground hasn't confirmed are sent, then the satellite
+ *   waits for the ground.
+ * - Once the chunks stop coming the ground answers with a NACK: the first chunk it is missing, next, and a
+ *   bitmap of the ARQ_WINDOW chunks from next on, bit i set if chunk next + i is missing. Everything before
+ *   next and every sent chunk whose bit is clear has been received. Each NACK carries a number the ground
+ *   counts up, so one the link delivers late or twice is ignored instead of sending the same chunks again.
+ * - The missing chunks are sent again, lowest first, then new chunks to fill the window. The stream is done
+ *   once the ground's next is past the last chunk.
+ *
+ * Since the ground only has to report what is missing, a lost frame costs one chunk, and the link stays busy
+ * with new chunks while there is room in the window. A chunk that can't be read from the card is counted,
+ * skipped for the next one and left for the ground to NACK.
+ *
+ * The link only runs one stream at a time (csStreamState.opcode), so there is one transfer, kept here. Its
+ * handle is still owned and closed by the stream command. Only called from the main loop.
+ *
+ * This is a library only for now. The stream commands and the link layer are outside this tree and still send
+ * getFile in order from csStreamState.getFile.bytesLeft; nothing calls arqStart yet. To switch over, getFile
+ * calls arqStart on its open handle in place of setting bytesLeft, queues what arqNext returns as DL_CHUNK items
+ * (see CSdownlink.c) while it returns chunks, hands each NACK the ground sends to arqNack, and ends the stream and
+ * closes the handle once arqDone. That needs the ground's NACK command, which the command parser doesn't have yet.
+ */
+
+#include "types.h"
+#include "CSopenSourceFAT.h"
+#include "CSarq.h"
+
+#define ARQ_MAX_CHUNKS 0xFFFF //sequence numbers are 16 bit
+
+static struct{
+    FSFILE*  handle;
+    uint32_t offset;  //file offset of chunk 0
+    uint32_t length;  //bytes in the stream
+    uint16_t total;   //chunks in the stream
+    uint16_t base;    //first chunk the ground hasn't confirmed
+    uint16_t sent;    //first chunk never sent
+    uint32_t resend;  //bit i set to send chunk base + i again
+    uint32_t pos;     //where the handle was left, to skip seeking for chunks read in order
+    BOOL     posKnown;
+    uint8_t  nack;    //number of the last NACK acted on
+    BOOL     nackSeen;
+} arq;
+
+static arq_stats_t arqStat;
+
+/*
+ * arqStart
+ * INPUT: FSFILE* handle - open file to stream from
+ *        uint32_t offset - where in it the stream starts
+ *        uint32_t length - bytes to stream
+ * OUTPUT: BOOL - false if there is no file or too many chunks to number
+ * INFO: Starts a new transfer, forgetting any earlier one.
+ */
+BOOL arqStart(FSFILE* handle, uint32_t offset, uint32_t length){
+    uint32_t total = (length + ARQ_CHUNK_BYTES - 1) / ARQ_CHUNK_BYTES;
+    memset(&arq, 0, sizeof(arq));
+    if((handle == NULL) || (total > ARQ_MAX_CHUNKS)){
+        return false;
+    }
+    arq.handle = handle;
+    arq.offset = offset;
+    arq.length = length;
+    arq.total = (uint16_t)total;
+    return true;
+}
+
+/*
+ * arqRead
+ * INPUT: uint16_t seq - chunk to read
+ *        uint8_t* chunk - filled with it, ARQ_SEQ_BYTES + ARQ_CHUNK_BYTES long
+ * OUTPUT: uint16_t - bytes filled in, 0 if it couldn't be read from the card
+ */
+static uint16_t arqRead(uint16_t seq, uint8_t* chunk){
+    uint32_t at = (uint32_t)seq * ARQ_CHUNK_BYTES;
+    uint16_t len = ((arq.length - at) < ARQ_CHUNK_BYTES) ? (uint16_t)(arq.length - at) : ARQ_CHUNK_BYTES;
+    at += arq.offset;
+    if(!arq.posKnown || (arq.pos != at)){
+        if(FSfseek(arq.handle, (long)at, SEEK_SET) != 0){
+            arq.posKnown = false;
+            return 0;
+        }
+    }
+    if(FSfread(&chunk[ARQ_SEQ_BYTES], len, 1, arq.handle) != 1){
+        arq.posKnown = false;
+        return 0;
+    }
+    arq.pos = at + len;
+    arq.posKnown = true;
+    chunk[0] = (seq >> 8);
+    chunk[1] = seq;
+    return (ARQ_SEQ_BYTES + len);
+}
+
+/*
+ * arqNext
+ * INPUT: uint8_t* chunk - filled with the next chunk to send, ARQ_SEQ_BYTES + ARQ_CHUNK_BYTES long
+ * OUTPUT: uint16_t - bytes filled in, 0 only if nothing can be sent until the ground's next NACK
+ * INFO: Chunks the ground is missing go first, then new chunks while they fit in the window. A chunk that
+ *       can't be read is counted in errors and the next one is tried, the ground NACKs it like a lost one.
+ *       Only the chunks to resend and the rest of the window are tried, so a card that fails every read can't
+ *       hold it up.
+ */
+uint16_t arqNext(uint8_t* chunk){
+    uint16_t seq;
+    uint16_t len;
+    if(arq.handle == NULL){
+        return 0;
+    }
+    for(;;){
+        if(arq.resend != 0){
+            uint8_t i = 0;
+            while(!(arq.resend & ((uint32_t)1 << i))){
+                i++;
+            }
+            arq.resend &= ~((uint32_t)1 << i);
+            seq = arq.base + i;
+            arqStat.resent++;
+        }
+        else if((arq.sent < arq.total) && ((uint16_t)(arq.sent - arq.base) < ARQ_WINDOW)){
+            seq = arq.sent++;
+            arqStat.chunks++;
+        }
+        else{
+            return 0; //waiting for the ground
+        }
+        len = arqRead(seq, chunk);
+        if(len != 0){
+            return len;
+        }
+        arqStat.errors++;
+    }
+}
+
+/*
+ * arqNack
+ * INPUT: uint8_t nack - the ground's number for this NACK, one more than its last
+ *        uint16_t next - first chunk the ground is missing, everything before it was received
+ *        uint32_t missing - bit i set if chunk next + i is missing
+ * OUTPUT: none
+ * INFO: Moves the window up to next and marks the missing chunks that were sent to be sent again. A NACK
+ *       numbered the same as or before the last one acted on, or for chunks never sent, is ignored and
+ *       counted in stale: acting on it would send chunks again that are already on their way.
+ */
+void arqNack(uint8_t nack, uint16_t next, uint32_t missing){
+    uint16_t span;
+    arqStat.nacks++;
+    if(arq.handle == NULL){
+        return;
+    }
+    if((arq.nackSeen && ((int8_t)(nack - arq.nack) <= 0)) || (next < arq.base) || (next > arq.sent)){
+        arqStat.stale++;
+        return;
+    }
+    arq.nack = nack;
+    arq.nackSeen = true;
+    arq.base = next;
+    span = arq.sent - arq.base; //chunks sent that may be missing, at most ARQ_WINDOW
+    if(span < ARQ_WINDOW){
+        missing &= (((uint32_t)1 << span) - 1);
+    }
+    arq.resend = missing;
+}
+
+/*
+ * arqDone
+ * INPUT: none
+ * OUTPUT: BOOL - true once the ground has confirmed every chunk
+ */
+BOOL arqDone(){
+    return (arq.handle != NULL) && (arq.base >= arq.total);
+}
+
+/*
+ * arqStats
+ * INPUT: arq_stats_t* stats - returns the counts so far
+ *        BOOL reset - true to start counting again
+ * OUTPUT: none
+ */
+void arqStats(arq_stats_t* stats, BOOL reset){
+    *stats = arqStat;
+    if(reset){
+        memset(&arqStat, 0, sizeof(arqStat));
+    }
+}
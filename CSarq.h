@@ -0,0 +1,37 @@
+/*
+ * File:   CSarq.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Selective repeat for streaming part of a file to the ground, see CSarq.c
+ */
+
+#ifndef CSARQ_H
+#define	CSARQ_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CSopenSourceFAT.h"
+#include "CSdownlink.h"
+
+#define ARQ_SEQ_BYTES   2                              //sequence number before each chunk, MSB first
+#define ARQ_CHUNK_BYTES (DL_ITEM_MAX - ARQ_SEQ_BYTES)  //file bytes in a chunk, so a chunk is one downlink item
+#define ARQ_WINDOW      32                             //chunks sent before waiting for the ground, one bit each
+
+typedef struct{
+    uint32_t chunks;  //chunks sent the first time
+    uint32_t resent;  //chunks sent again
+    uint32_t nacks;   //NACKs from the ground
+    uint32_t stale;   //NACKs ignored as late, repeated or for chunks never sent
+    uint32_t errors;  //chunks that couldn't be read from the card and were skipped
+} arq_stats_t;
+
+BOOL arqStart(FSFILE* handle, uint32_t offset, uint32_t length);
+uint16_t arqNext(uint8_t* chunk);
+void arqNack(uint8_t nack, uint16_t next, uint32_t missing);
+BOOL arqDone();
+void arqStats(arq_stats_t* stats, BOOL reset);
+
+#endif	/* CSARQ_H */
+
@@ -7,6 +7,7 @@
 
 #include "types.h"
 #include "Globals.h"
+#include "CSdefine.h"
 #include "metal/beacon.h"
 #include "CSbeacon.h"
 
@@ -36,7 +37,7 @@ bool beaconEnable(bool enabled){
  * INPUT: none
  * OUTPUT: none
  * INFO: The beacon needs to be set to a default string and all A's was selected since
- *       it is the minimum or OK value for each.
+ *       it is the minimum or OK value for each. The beacon layout is also returned to the default one.
  */
 void beaconMsgInit(){
  char defaultString[31];
@@ -45,107 +46,215 @@ void beaconMsgInit(){
      defaultString[i] = 'A';
  }
  G_SET(csBeacon.beaconMsg,defaultString);
+ beaconLayoutDefault();
 }
 
 /*
- * beaconMsgUpdateTelemetry
- * INPUT: none
- * OUTPUT: none
- * INFO: A majority of the beacon values are based on telemetry. The csLastTelemetry set of readings
- *       is used to update it. Since the beacon values are not in the same order as the collected telemetry
- *       and they are also not consecutive, the beacon characters are set in order. Functions are used to
- *       convert the count into the appropriate character as per the beacon requirements.
+ * Beacon character for each encoded value 0-33, as per the beacon requirements.
+ * 0-23 are A-Z with E and T skipped, 24-33 are 0-9.
  */
-void beaconMsgUpdateTelemetry(){
-    char tempChar;
-    dprintf("Updating beacon telemetry values:\r\n");
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[19]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[SC_BATT_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[20]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[SC_BATT_A], &tempChar);
-
-    tempChar = getTempChar(21); //temperature values need a bit more work, therefore it has its own seperate function
-    G_SET(csBeacon.beaconMsg[SC_BATT_T], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[26]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[PL_BATT_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[27]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[PL_BATT_A], &tempChar);
-
-    tempChar = getTempChar(28);
-    G_SET(csBeacon.beaconMsg[PL_BATT_T], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[16]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[15]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[43]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW1_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[42]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW1_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[41]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW2_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[40]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW2_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[39]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW3_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[38]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW3_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[18]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW4_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[17]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V3d3_SW4_A], &tempChar);
-
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[12]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V5_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[11]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V5_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[14]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V5_SW5_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[13]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V5_SW5_A], &tempChar);
-
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[8]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V12_V], &tempChar);
-
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[7]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V12_A], &tempChar);
+static const char BEACON_CHARS[34] = {
+    'A','B','C','D','F','G','H','I','J','K','L','M',
+    'N','O','P','Q','R','S','U','V','W','X','Y','Z',
+    '0','1','2','3','4','5','6','7','8','9'
+};
 
+/*
+ * Default telemetry backed beacon characters. Since the beacon values are not in the same order
+ * as the collected telemetry and they are also not consecutive, each beacon character
+ * is listed with the csLastTelemetry reading it is built from. Any character not listed is BEACON_FIXED.
+ */
+static const struct{
+    uint8_t slot;     //beacon_msg_index_t
+    uint8_t reading;  //index into csLastTelemetry.reading
+    uint8_t encoding; //beacon_encoding_t
+} BEACON_DEFAULT_LAYOUT[] = {
+    {SC_BATT_V,   19, BEACON_LINEAR},
+    {SC_BATT_A,   20, BEACON_LINEAR},
+    {SC_BATT_T,   21, BEACON_TEMP},
+    {PL_BATT_V,   26, BEACON_LINEAR},
+    {PL_BATT_A,   27, BEACON_LINEAR},
+    {PL_BATT_T,   28, BEACON_TEMP},
+    {V3d3_V,      16, BEACON_LINEAR},
+    {V3d3_A,      15, BEACON_LINEAR},
+    {V3d3_SW1_V,  43, BEACON_LINEAR},
+    {V3d3_SW1_A,  42, BEACON_LINEAR},
+    {V3d3_SW2_V,  41, BEACON_LINEAR},
+    {V3d3_SW2_A,  40, BEACON_LINEAR},
+    {V3d3_SW3_V,  39, BEACON_LINEAR},
+    {V3d3_SW3_A,  38, BEACON_LINEAR},
+    {V3d3_SW4_V,  18, BEACON_LINEAR},
+    {V3d3_SW4_A,  17, BEACON_LINEAR},
+    {V5_V,        12, BEACON_LINEAR},
+    {V5_A,        11, BEACON_LINEAR},
+    {V5_SW5_V,    14, BEACON_LINEAR},
+    {V5_SW5_A,    13, BEACON_LINEAR},
+    {V12_V,        8, BEACON_LINEAR},
+    {V12_A,        7, BEACON_LINEAR},
+    {V12_SW6_V,   10, BEACON_LINEAR},
+    {V12_SW6_A,    9, BEACON_LINEAR},
+    {RADIO_T,     24, BEACON_TEMP},
+};
 
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[10]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V12_SW6_V], &tempChar);
+/*
+ * beaconTempIndex
+ * INPUT: uint16_t count - raw count of a temperature reading
+ *        uint16_t offset - count that sets the minimum that is to be looked for
+ *        uint8_t shift - number of least significant bits that are dropped
+ * OUTPUT: uint8_t - encoded beacon value 0-33
+ * INFO: Adjusts the count down by the offset. Anything at or below it is the minimum value,
+ *       otherwise the count is shifted down and anything over 33 is set as the max value.
+ */
+static uint8_t beaconTempIndex(uint16_t count, uint16_t offset, uint8_t shift){
+    int16_t temp = (count - offset);
+    if(temp <= 0){
+        return 0;
+    }
+    temp = (temp >> shift);
+    if(temp >= 33){
+        return 33;
+    }
+    return temp;
+}
 
-    tempChar = intToBeaconChar(((Global->csLastTelemetry.reading[9]) >> 7)); //12 bits, don't care about least significant 2
-    G_SET(csBeacon.beaconMsg[V12_SW6_A], &tempChar);
+/*
+ * beaconSlotChar
+ * INPUT: beacon_slot_t const* slot - compiled layout entry of a telemetry backed beacon character
+ * OUTPUT: char - the beacon character for the current reading
+ * INFO: Linear values that fall outside of 0-33 are not valid and give the minimum character,
+ *       the same as intToBeaconChar does.
+ */
+static char beaconSlotChar(beacon_slot_t const* slot){
+    uint16_t count = Global->csLastTelemetry.reading[slot->reading];
+    uint16_t val;
+    if(slot->encoding == BEACON_TEMP){
+        return BEACON_CHARS[beaconTempIndex(count, slot->offset, slot->shift)];
+    }
+    if(count < slot->offset){
+        return 'A';
+    }
+    val = ((count - slot->offset) >> slot->shift);
+    if(val >= sizeof(BEACON_CHARS)){
+        return 'A';
+    }
+    return BEACON_CHARS[val];
+}
 
+/*
+ * beaconLayoutDefault
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Compiles BEACON_DEFAULT_LAYOUT into the beacon layout table. Linear values use the 5 most significant
+ *       bits of the 12 bit counts and temperatures use the curve described in getTempChar.
+ */
+void beaconLayoutDefault(){
+    beacon_slot_t layout[BEACON_MSG_LENGTH];
+    uint8_t i;
+    memset(layout, 0, sizeof(layout)); //everything BEACON_FIXED
+    for(i = 0; i < (sizeof(BEACON_DEFAULT_LAYOUT)/sizeof(BEACON_DEFAULT_LAYOUT[0])); i++){
+        beacon_slot_t* slot = &layout[BEACON_DEFAULT_LAYOUT[i].slot];
+        slot->reading = BEACON_DEFAULT_LAYOUT[i].reading;
+        slot->encoding = BEACON_DEFAULT_LAYOUT[i].encoding;
+        if(slot->encoding == BEACON_TEMP){
+            slot->offset = BEACON_TEMP_OFFSET;
+            slot->shift = BEACON_TEMP_SHIFT;
+        }
+        else{
+            slot->offset = 0;
+            slot->shift = 7;
+        }
+    }
+    G_SET(csBeacon.layout, layout);
+}
 
-    tempChar = getTempChar(24);
-    G_SET(csBeacon.beaconMsg[RADIO_T], &tempChar);
+/*
+ * beaconLayoutLoad
+ * INPUT: uint8_t const* desc - layout descriptor uploaded by the ground
+ *        uint16_t len - number of bytes in the descriptor
+ * OUTPUT: uint8_t - 0 if the layout was changed, 0xFF if the length is not a whole number of records,
+ *         0xFE if any record is invalid
+ * INFO: Lets the ground repurpose beacon characters mid-mission without a firmware upload.
+ *       The descriptor is a list of BEACON_LAYOUT_RECORD_BYTES byte records, one per beacon character to change:
+ *           [0]   beacon character (beacon_msg_index_t), SC_BATT_V and up
+ *           [1]   sensor index into csLastTelemetry
+ *           [2]   encoding (beacon_encoding_t) in the high nibble, shift in the low nibble
+ *           [3-4] offset, MSB first
+ *       Characters not listed keep their current definition. Every record is validated before anything is
+ *       changed so a bad upload never leaves a half applied layout, then the compiled table is written with one G_SET.
+ *       The new layout shows up in the beacon with the next telemetry update.
+ */
+uint8_t beaconLayoutLoad(uint8_t const* desc, uint16_t len){
+    beacon_slot_t layout[BEACON_MSG_LENGTH];
+    uint16_t i;
+    if((len == 0) || ((len % BEACON_LAYOUT_RECORD_BYTES) != 0)){
+        return 0xFF;
+    }
+    for(i = 0; i < len; i += BEACON_LAYOUT_RECORD_BYTES){
+        //the status characters at the start of the beacon are always set manually
+        if((desc[i] < SC_BATT_V) || (desc[i] >= BEACON_MSG_LENGTH)){
+            return 0xFE;
+        }
+        if((desc[i+1] >= NUM_SENSORS) || ((desc[i+2] >> 4) > BEACON_TEMP)){
+            return 0xFE;
+        }
+    }
+    memcpy(layout, Global->csBeacon.layout, sizeof(layout));
+    for(i = 0; i < len; i += BEACON_LAYOUT_RECORD_BYTES){
+        beacon_slot_t* slot = &layout[desc[i]];
+        slot->reading = desc[i+1];
+        slot->encoding = (desc[i+2] >> 4);
+        slot->shift = (desc[i+2] & 0x0F);
+        slot->offset = ((uint16_t)desc[i+3] << 8) | desc[i+4];
+    }
+    G_SET(csBeacon.layout, layout);
+    return 0;
+}
 
+/*
+ * beaconMsgUpdateTelemetry
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: A majority of the beacon values are based on telemetry. The csLastTelemetry set of readings
+ *       is used to update it. Called from the telemetry path each second so the beacon is always
+ *       current by the time BEACON_ON sends it.
+ *       Each telemetry backed character in the layout table (see beaconLayoutLoad) is encoded through the
+ *       BEACON_CHARS lookup table and compared to what is already in the beacon. Characters that changed are marked in a
+ *       dirty mask (bit n is beacon character n) and only those runs of characters are written back,
+ *       so a steady satellite costs no global writes at all.
+ */
+void beaconMsgUpdateTelemetry(){
+    char msg[sizeof(Global->csBeacon.beaconMsg)];
+    uint32_t dirty = 0;
+    uint8_t i;
+    for(i = 0; i < BEACON_MSG_LENGTH; i++){
+        if(Global->csBeacon.layout[i].encoding == BEACON_FIXED){
+            continue;
+        }
+        msg[i] = beaconSlotChar(&Global->csBeacon.layout[i]);
+        if(msg[i] != Global->csBeacon.beaconMsg[i]){
+            dirty |= ((uint32_t)1 << i);
+        }
+    }
+    if(dirty == 0){
+        return;
+    }
+    //write back each run of changed characters
+    i = 0;
+    while(dirty != 0){
+        if(dirty & 1){
+            uint8_t len = 0;
+            while(dirty & 1){
+                len++;
+                dirty >>= 1;
+            }
+            G_CPY(csBeacon.beaconMsg[i], &msg[i], len);
+            i += len;
+        }
+        else{
+            dirty >>= 1;
+            i++;
+        }
+    }
 }
 
 /*
@@ -192,26 +301,11 @@ void beaconMsgUpdateSingle(beacon_msg_index_t index, char val){
  */
 
 char intToBeaconChar(uint16_t val){
-    if(val >= 34){
+    if(val >= sizeof(BEACON_CHARS)){
         dprintf("intToBeaconChar received an invalit integer input %ul\r\n", val);
         return 'A';
     }
-    char ret;
-    if(val < 24){ //0-23
-        ret = val + 65;
-        if(ret >= 'S'){ //skipping E and T
-            ret += 2;
-        }
-        else if(ret >= 'E'){ //just skipping E
-            ret++;
-        }
-    }
-    else{ // val >= 24 && val <34
-        ret = val + 24; //'0' == 48
-    }
-
-    //dprintf ("intToBeaconChar input of %ul became %c",val, ret);
-    return ret;
+    return BEACON_CHARS[val];
 }
 
 /*
@@ -225,25 +319,5 @@ char intToBeaconChar(uint16_t val){
  *       are used to determine the character. 0-33 are set as the specified chracter, but over 33 is also set as the max character.
  */
 uint8_t getTempChar(uint8_t index){
-    char tempChar;
-    //get value and adjust it down by 1385
-    int16_t temp = (Global->csLastTelemetry.reading[index] - 1385);
-    //negative counts are all too low, set to the min
-    if(temp <= 0){
-        tempChar = intToBeaconChar(0);
-    }
-    //everything else needs step 2
-    else{
-        //only care about 7 most significant bits
-        temp = (temp >> 5);
-        //over range goes to max char
-        if (temp >= 33){
-            tempChar = intToBeaconChar(33);
-        }
-        //otherwise get the appropriate character
-        else{
-            tempChar = intToBeaconChar(temp);
-        }
-    }
-    return tempChar;
-}
\ No newline at end of file
+    return BEACON_CHARS[beaconTempIndex(Global->csLastTelemetry.reading[index], BEACON_TEMP_OFFSET, BEACON_TEMP_SHIFT)];
+}
@@ -42,12 +42,35 @@ typedef enum{
     RADIO_T,        //30
 } beacon_msg_index_t;
 
+#define BEACON_MSG_LENGTH       31
+#define BEACON_TEMP_OFFSET    1385 //count subtracted from temperatures before encoding
+#define BEACON_TEMP_SHIFT        5
+
+typedef enum{
+    BEACON_FIXED  = 0, //not telemetry backed, only set through beaconMsgUpdateSingle
+    BEACON_LINEAR = 1, //(count - offset) >> shift
+    BEACON_TEMP   = 2, //temperature curve, see getTempChar
+} beacon_encoding_t;
+
+//compiled description of where one beacon character comes from
+typedef struct{
+    uint16_t offset;       //count subtracted from the reading before shifting
+    uint8_t  reading;      //index into csLastTelemetry.reading
+    uint8_t  encoding :4;  //beacon_encoding_t
+    uint8_t  shift    :4;  //number of least significant bits dropped
+} beacon_slot_t;
+
+//size of one record of an uploaded layout descriptor, see beaconLayoutLoad
+#define BEACON_LAYOUT_RECORD_BYTES 5
+
 bool beaconEnable(bool enabled);
 void beaconMsgInit();
 void beaconMsgUpdateTelemetry();
 void beaconMsgUpdateSingle(beacon_msg_index_t index, char val);
 char intToBeaconChar(uint16_t val);
 uint8_t getTempChar(uint8_t index);
+void beaconLayoutDefault();
+uint8_t beaconLayoutLoad(uint8_t const* desc, uint16_t len);
 
 
 #endif	/* CSBEACON_H */
@@ -0,0 +1,280 @@
+/*
+ * File:   CScondWatch.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * pendingProcess used to evaluate the exit conditions and the head command's wait conditions from scratch
+ * every second, even though a sequence usually sits waiting for minutes with nothing relevant changing.
+ * The result of each set of conditions is now cached along with what it would take to change it:
+ *
+ * - Each sensor comparison is only affected by whether the reading is below, equal to or above the value
+ *   it's compared to. Derived signals (CSderived.c) are watched the same way as readings. The band of readings
+ *   in the same region as when the set was evaluated is recorded, and the set is only marked dirty when
+ *   condWatchTelemetry sees a reading leave its band.
+ * - Time only moves forward, so each time comparison can only change when the time reaches its value, and
+ *   once more a second later. The earliest of these is the set's deadline.
+ *
+ * Condition programs are watched through every leaf in them. Nothing here is kept in the globals: after a
+ * reset, or if the cache is simply wrong, the only cost is evaluating the conditions again.
+ *
+ * pendingProcess evaluates with interrupts enabled, so a telemetry record can come in between reading the
+ * conditions and arming the watch, and the bands would then be taken from readings the result wasn't. Each
+ * record bumps a counter: pendingProcess takes condWatchStamp before evaluating and condWatchArm doesn't keep
+ * the result if the counter has moved since. The leaf list is shared with condWatchTelemetry in the telemetry
+ * interrupt, so it is only changed with interrupts held off.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CSlogging.h"
+#include "CScondition.h"
+#include "CScondWatch.h"
+#include "CSderived.h"
+
+typedef struct{
+    uint8_t  sensor;
+    uint8_t  set;
+    uint16_t lo;     //readings from lo to hi leave the comparison unchanged
+    uint16_t hi;
+} cond_watch_leaf_t;
+
+static struct{
+    struct{
+        conditions_t cond;    //what was evaluated
+        uint32_t relBase;     //time relative time conditions were measured from
+        uint32_t deadline;    //first time a time comparison may change
+        BOOL result;
+        uint8_t status;
+        BOOL valid;
+        volatile BOOL dirty;  //a reading left its band, set by the telemetry interrupt
+    } set[COND_WATCH_SETS];
+    cond_watch_leaf_t leaf[COND_WATCH_LEAVES];
+    uint8_t leaves;
+} condWatch;
+
+static volatile uint16_t condWatchRecords; //telemetry records seen by condWatchTelemetry
+
+//leaves of each top condition being armed, only used by condWatchArm in the main loop
+static condition_t condWatchScratch[2][COND_PROGRAM_SIZE / COND_LEAF_BYTES]; //most leaves a program can hold
+
+/*
+ * condWatchSameCond
+ * INPUT: condition_t const* a, condition_t const* b - conditions to compare
+ * OUTPUT: BOOL - true if they are the same comparison
+ */
+static BOOL condWatchSameCond(condition_t const* a, condition_t const* b){
+    return (a->sensor_id == b->sensor_id) && (a->comparator == b->comparator) && (a->value == b->value);
+}
+
+/*
+ * condWatchSame
+ * INPUT: conditions_t const* a, conditions_t const* b - sets of conditions to compare
+ * OUTPUT: BOOL - true if they would evaluate the same way
+ */
+static BOOL condWatchSame(conditions_t const* a, conditions_t const* b){
+    if((a->op != b->op) || !condWatchSameCond(&a->left, &b->left)){
+        return false;
+    }
+    return (a->op == JUST) || condWatchSameCond(&a->right, &b->right);
+}
+
+/*
+ * condWatchCached
+ * INPUT: cond_watch_set_t set - which set of conditions is being checked
+ *        conditions_t const* cond - the conditions as they are now
+ *        uint32_t relBase - lastCmdTime for relative time conditions
+ *        uint32_t now - csunSatEpoch time the conditions are being checked at
+ *        BOOL* result, uint8_t* status - return the cached result and status
+ * OUTPUT: BOOL - true if the cached result still holds, false if the conditions have to be evaluated
+ *         (and then given to condWatchArm)
+ * INFO: This is all an idle sequence costs each second.
+ */
+BOOL condWatchCached(cond_watch_set_t set, conditions_t const* cond, uint32_t relBase, uint32_t now,
+                     BOOL* result, uint8_t* status){
+    if(!condWatch.set[set].valid || condWatch.set[set].dirty || (now >= condWatch.set[set].deadline)){
+        return false;
+    }
+    if((condWatch.set[set].relBase != relBase) || !condWatchSame(&condWatch.set[set].cond, cond)){
+        return false;
+    }
+    *result = condWatch.set[set].result;
+    *status = condWatch.set[set].status;
+    return true;
+}
+
+/*
+ * condWatchStamp
+ * INPUT: none
+ * OUTPUT: uint16_t - to give to condWatchArm once the conditions have been evaluated
+ * INFO: Taken before evaluating, so condWatchArm can tell whether the readings changed meanwhile.
+ */
+uint16_t condWatchStamp(){
+    return condWatchRecords;
+}
+
+/*
+ * condWatchReading
+ * INPUT: uint16_t const* readings - csLastTelemetry readings
+ *        uint8_t sensor - sensor ID of a watched comparison, a sensor or a derived signal
+ * OUTPUT: uint16_t - what the comparison is made against
+ */
+static uint16_t condWatchReading(uint16_t const* readings, uint8_t sensor){
+    return (sensor < NUM_SENSORS) ? readings[sensor] : derivedReading(sensor);
+}
+
+/*
+ * condWatchLeaf
+ * INPUT: cond_watch_set_t set - set the comparison belongs to
+ *        condition_t const* leaf - a single comparison
+ *        uint32_t relBase - lastCmdTime for relative time conditions
+ *        uint32_t now - csunSatEpoch time the conditions were evaluated at
+ * OUTPUT: BOOL - false if there was no room to watch it
+ * INFO: A sensor comparison gets a band, a time comparison brings the set's deadline in if it's sooner.
+ *       Called with interrupts held off.
+ */
+static BOOL condWatchLeaf(cond_watch_set_t set, condition_t const* leaf, uint32_t relBase, uint32_t now){
+    uint32_t val;
+    if((leaf->sensor_id < NUM_SENSORS) || PSENSOR_IS_DERIVED(leaf->sensor_id)){
+        cond_watch_leaf_t* w;
+        if(condWatch.leaves == COND_WATCH_LEAVES){
+            return false;
+        }
+        w = &condWatch.leaf[condWatch.leaves];
+        val = condWatchReading(Global->csLastTelemetry.reading, leaf->sensor_id);
+        w->sensor = leaf->sensor_id;
+        w->set = set;
+        if(val < leaf->value){
+            w->lo = 0;
+            w->hi = (leaf->value > 0xFFFF) ? 0xFFFF : (leaf->value - 1);
+        }
+        else if(val == leaf->value){
+            w->lo = val;
+            w->hi = val;
+        }
+        else{
+            w->lo = leaf->value + 1;
+            w->hi = 0xFFFF;
+        }
+        condWatch.leaves++;
+    }
+    else if((leaf->sensor_id == PSENSOR_ABSOLUTE_TIME) || (leaf->sensor_id == PSENSOR_COMMAND_RELATIVE_TIME)){
+        uint32_t deadline = COND_WATCH_NEVER;
+        val = now;
+        if(leaf->sensor_id == PSENSOR_COMMAND_RELATIVE_TIME){
+            val -= relBase;
+        }
+        if(val < leaf->value){
+            deadline = now + (leaf->value - val);
+        }
+        else if(val == leaf->value){
+            deadline = now + 1;
+        }
+        if(deadline < condWatch.set[set].deadline){
+            condWatch.set[set].deadline = deadline;
+        }
+    }
+    //anything else never changes, it's always compared to the same thing
+    return true;
+}
+
+/*
+ * condWatchArm
+ * INPUT: cond_watch_set_t set - which set of conditions was evaluated
+ *        conditions_t const* cond - the conditions that were evaluated
+ *        uint32_t relBase - lastCmdTime for relative time conditions
+ *        uint32_t now - csunSatEpoch time the conditions were evaluated at
+ *        uint16_t stamp - condWatchStamp from before they were evaluated
+ *        BOOL result, uint8_t status - the result of evaluating them
+ * OUTPUT: none
+ * INFO: Replaces whatever was watched for the set. Every comparison is watched, including ones the evaluation
+ *       didn't reach because of short-circuiting, since those can change the result too. If there are too many
+ *       comparisons to watch or a program can't be followed, the set is left unwatched and is evaluated every time.
+ *       So is a set whose readings changed after the stamp was taken, until it is evaluated again.
+ */
+void condWatchArm(cond_watch_set_t set, conditions_t const* cond, uint32_t relBase, uint32_t now, uint16_t stamp,
+                  BOOL result, uint8_t status){
+    uint8_t counts[2];
+    condition_t const* top[2];
+    uint8_t tops = (cond->op == JUST) ? 1 : 2;
+    uint8_t i, j;
+    BOOL ok = true;
+    cpu_priority_t priority;
+
+    //programs are followed before interrupts are held off, only the main loop changes them
+    top[0] = &cond->left;
+    top[1] = &cond->right;
+    for(i = 0; i < tops; i++){
+        counts[i] = 0;
+        if(top[i]->sensor_id == PSENSOR_CONDITION_PROGRAM){
+            counts[i] = condProgramLeaves(top[i]->value, condWatchScratch[i],
+                                          sizeof(condWatchScratch[i]) / sizeof(condWatchScratch[i][0]));
+            ok = ok && (counts[i] != 0xFF);
+        }
+    }
+
+    priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY); //condWatchTelemetry goes through the leaves
+    //drop everything the set watched before
+    for(i = 0, j = 0; i < condWatch.leaves; i++){
+        if(condWatch.leaf[i].set != set){
+            condWatch.leaf[j++] = condWatch.leaf[i];
+        }
+    }
+    condWatch.leaves = j;
+
+    condWatch.set[set].cond = *cond;
+    condWatch.set[set].relBase = relBase;
+    condWatch.set[set].deadline = COND_WATCH_NEVER;
+    condWatch.set[set].result = result;
+    condWatch.set[set].status = status;
+    condWatch.set[set].dirty = false;
+    ok = ok && (stamp == condWatchRecords); //otherwise the bands would come from readings that weren't evaluated
+    for(i = 0; ok && (i < tops); i++){
+        if(top[i]->sensor_id == PSENSOR_CONDITION_PROGRAM){
+            for(j = 0; ok && (j < counts[i]); j++){
+                ok = condWatchLeaf(set, &condWatchScratch[i][j], relBase, now);
+            }
+        }
+        else{
+            ok = condWatchLeaf(set, top[i], relBase, now);
+        }
+    }
+    condWatch.set[set].valid = ok;
+    Metal_SetCPUPriority(priority);
+}
+
+/*
+ * condWatchTelemetry
+ * INPUT: uint16_t const* readings - the new csLastTelemetry readings
+ * OUTPUT: none
+ * INFO: Called each time telemetry is recorded, after the derived signals are updated. Only the watched readings
+ *       are looked at, and any set with a reading outside its band is marked to be evaluated again.
+ */
+void condWatchTelemetry(uint16_t const* readings){
+    uint8_t i;
+    for(i = 0; i < condWatch.leaves; i++){
+        cond_watch_leaf_t const* w = &condWatch.leaf[i];
+        uint16_t val = condWatchReading(readings, w->sensor);
+        if((val < w->lo) || (val > w->hi)){
+            condWatch.set[w->set].dirty = true;
+        }
+    }
+    condWatchRecords++;
+}
+
+/*
+ * condWatchInvalidate
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Forgets every cached result, for changes the watch can't see such as new condition programs.
+ */
+void condWatchInvalidate(){
+    uint8_t i;
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    for(i = 0; i < COND_WATCH_SETS; i++){
+        condWatch.set[i].valid = false;
+    }
+    condWatch.leaves = 0;
+    Metal_SetCPUPriority(priority);
+}
@@ -0,0 +1,37 @@
+/*
+ * File:   CScondWatch.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Caches wait and exit condition results until something they depend on changes, see CScondWatch.c
+ */
+
+#ifndef CSCONDWATCH_H
+#define	CSCONDWATCH_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+
+#define COND_WATCH_LEAVES 64         //sensor comparisons that can be watched across every set
+#define COND_WATCH_NEVER  0xFFFFFFFF //deadline of a set with no time comparisons
+
+//each sequence slot has two sets of conditions that are watched
+#define COND_WATCH_EXIT(slot) ((slot) * 2)     //the sequence's exit conditions
+#define COND_WATCH_WAIT(slot) ((slot) * 2 + 1) //wait conditions of the command at the head of the sequence
+#define COND_WATCH_SETS       (NUM_SEQUENCES * 2)
+
+typedef uint8_t cond_watch_set_t;
+
+BOOL condWatchCached(cond_watch_set_t set, conditions_t const* cond, uint32_t relBase, uint32_t now,
+                     BOOL* result, uint8_t* status);
+uint16_t condWatchStamp();
+void condWatchArm(cond_watch_set_t set, conditions_t const* cond, uint32_t relBase, uint32_t now, uint16_t stamp,
+                  BOOL result, uint8_t status);
+void condWatchTelemetry(uint16_t const* readings);
+void condWatchInvalidate();
+
+#endif	/* CSCONDWATCH_H */
+
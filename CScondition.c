@@ -0,0 +1,308 @@
+/*
+ * File:   CScondition.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * A conditions_t can only hold one or two comparisons joined by JUST, AND or OR. Condition programs let
+ * the ground describe any AND/OR/NOT combination of comparisons, so a whole safety envelope fits in one
+ * exit condition. A condition_t whose sensor ID is PSENSOR_CONDITION_PROGRAM uses its value as the offset
+ * of a program in csCondProgram, which the ground uploads with condProgramLoad.
+ *
+ * Programs are bytecode for a small stack machine whose stack holds booleans (see cond_opcode_t).
+ * An AND of two comparisons is
+ *     LEAF a, JUMP_FALSE over b and the AND, LEAF b, AND, END
+ * The jumps let a program skip the rest of an AND once it's false or an OR once it's true, so only the
+ * comparisons needed to decide the result are made. Every leaf carries a tag picked by the ground and the
+ * status of a program is COND_STATUS_LEAF + the tag of the last leaf evaluated, the one that decided it.
+ *
+ * Leaves can't compare the time since the last command (PSENSOR_COMMAND_RELATIVE_TIME). A plain relative time
+ * exit condition is turned into an absolute time once, when its sequence starts, but the same leaf in a program
+ * would be measured from the last command and move with every command run. A relative wait is written as a
+ * plain condition next to the program instead, for instance left relative time AND right program.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "CSlogging.h"
+#include "CSpendingCommand.h"
+#include "CSpollLog.h"
+#include "CScondition.h"
+#include "CScondWatch.h"
+#include "CSderived.h"
+
+//bit n is set if a program starts at offset n of csCondProgram, see condProgramIndex
+static uint8_t condStarts[(COND_PROGRAM_SIZE + 7) / 8];
+//value of the leaf at offset n of csCondProgram, at condLeafValue[n / 8]. Leaves are 8 bytes long, so no
+//two of them share an entry.
+static uint32_t condLeafValue[COND_PROGRAM_SIZE / COND_LEAF_BYTES];
+
+/*
+ * condProgramIndex
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Finds where each program in csCondProgram starts, so condProgramEval doesn't have to check the
+ *       program again every time, and decodes the value of every leaf. Only csCondProgram as written by condProgramLoad is walked, which always
+ *       holds whole programs. Called whenever csCondProgram is written: by condProgramLoad and after the poll
+ *       log restores it.
+ */
+void condProgramIndex(){
+    uint8_t const* code = Global->csCondProgram.code;
+    uint16_t len = Global->csCondProgram.len;
+    uint16_t pc = 0;
+    BOOL starting = true;
+    memset(condStarts, 0, sizeof(condStarts));
+    if(len > COND_PROGRAM_SIZE){
+        return; //not a loaded program, nothing can be run
+    }
+    while(pc < len){
+        if(starting){
+            condStarts[pc >> 3] |= (1u << (pc & 7));
+            starting = false;
+        }
+        switch(code[pc]){
+            case COND_LEAF:
+                if(pc + COND_LEAF_BYTES > len){
+                    return;
+                }
+                condLeafValue[pc >> 3] = ((uint32_t)code[pc+4] << 24) | ((uint32_t)code[pc+5] << 16)
+                                       | ((uint32_t)code[pc+6] << 8) | code[pc+7];
+                pc += COND_LEAF_BYTES;
+                break;
+            case COND_JUMP_FALSE:
+            case COND_JUMP_TRUE:
+                pc += COND_JUMP_BYTES;
+                break;
+            case COND_END:
+                starting = true;
+                pc++;
+                break;
+            default:
+                pc++;
+                break;
+        }
+    }
+}
+
+/*
+ * condProgramLoad
+ * INPUT: uint8_t const* code - programs uploaded by the ground, one after another
+ *        uint16_t len - number of bytes of code
+ * OUTPUT: uint8_t - 0 if the programs were loaded, 0xFF if the length is invalid, 0xFE if any program is invalid
+ * INFO: Replaces every condition program. Each program is checked before anything is changed:
+ *       - every opcode is known and every instruction is complete
+ *       - leaves compare a sensor reading, a derived signal or an absolute time, with a known comparator and a tag
+ *         below COND_MAX_TAGS. A leaf can't refer to another program or a relative time.
+ *       - jumps only go forward and stay within their own program
+ *       - the stack never underflows or grows past COND_STACK_DEPTH, is the same depth wherever paths
+ *         join, and holds exactly one value at each END
+ *       - the code finishes with an END
+ *       Since all of this is checked here the evaluator only has to make sure it starts at the start of a
+ *       program (see condProgramIndex). The programs are written with a single G_SET and logged with the sequence.
+ */
+uint8_t condProgramLoad(uint8_t const* code, uint16_t len){
+    cond_program_t prog;
+    uint8_t joinDepth[COND_PROGRAM_SIZE + 1]; //depth+1 a jump expects at each byte, 0 if no jump lands there
+    uint16_t pc = 0;
+    uint16_t lastTarget = 0;
+    uint8_t depth = 0;
+    if((len == 0) || (len > COND_PROGRAM_SIZE)){
+        return 0xFF;
+    }
+    memset(joinDepth, 0, sizeof(joinDepth));
+    while(pc < len){
+        uint16_t target;
+        if((joinDepth[pc] != 0) && (joinDepth[pc] != (depth + 1))){
+            return 0xFE;
+        }
+        switch(code[pc]){
+            case COND_LEAF:
+                if((pc + COND_LEAF_BYTES > len) || (depth == COND_STACK_DEPTH) || (code[pc+1] >= COND_MAX_TAGS)
+                        || (code[pc+3] > GREATER)){
+                    return 0xFE;
+                }
+                if((code[pc+2] >= NUM_SENSORS) && (code[pc+2] != PSENSOR_ABSOLUTE_TIME) && !PSENSOR_IS_DERIVED(code[pc+2])){
+                    return 0xFE;
+                }
+                depth++;
+                pc += COND_LEAF_BYTES;
+                break;
+            case COND_AND:
+            case COND_OR:
+                if(depth < 2){
+                    return 0xFE;
+                }
+                depth--;
+                pc++;
+                break;
+            case COND_NOT:
+                if(depth < 1){
+                    return 0xFE;
+                }
+                pc++;
+                break;
+            case COND_JUMP_FALSE:
+            case COND_JUMP_TRUE:
+                if((pc + COND_JUMP_BYTES > len) || (depth < 1)){
+                    return 0xFE;
+                }
+                target = pc + COND_JUMP_BYTES + code[pc+1];
+                if((target > len) || ((joinDepth[target] != 0) && (joinDepth[target] != (depth + 1)))){
+                    return 0xFE;
+                }
+                joinDepth[target] = depth + 1;
+                if(target > lastTarget){
+                    lastTarget = target;
+                }
+                pc += COND_JUMP_BYTES;
+                break;
+            case COND_END:
+                //a jump may land on its program's END, but no further
+                if((depth != 1) || (lastTarget > pc)){
+                    return 0xFE;
+                }
+                depth = 0;
+                pc++;
+                break;
+            default:
+                return 0xFE;
+        }
+    }
+    if((depth != 0) || (lastTarget >= len)){
+        return 0xFE; //the last program has no END
+    }
+    memset(&prog, 0, sizeof(prog));
+    prog.len = len;
+    memcpy(prog.code, code, len);
+    G_SET(csCondProgram, &prog);
+    condProgramIndex();
+    condWatchInvalidate(); //cached results may have come from the old programs
+    derivedRefsChanged();
+    pollLogAppend(POLL_LOG_COND_LOAD, code, len);
+    return 0;
+}
+
+//for each comparator, which of below (1), equal (2) and above (4) make it true
+static const uint8_t COND_COMPARE[GREATER + 1] = {
+    [LESS] = 1, [LESS_EQ] = 3, [EQUAL] = 2, [GREATER_EQ] = 6, [GREATER] = 4
+};
+
+/*
+ * condLeaf
+ * INPUT: uint8_t const* leaf - COND_LEAF instruction
+ *        uint32_t value - value it compares to, as decoded by condProgramIndex
+ *        uint32_t now - csunSatEpoch time the conditions are being checked at
+ * OUTPUT: uint32_t - 1 if the comparison is true, 0 if not
+ * INFO: Same comparison as checkCond.
+ */
+static uint32_t condLeaf(uint8_t const* leaf, uint32_t value, uint32_t now){
+    uint32_t sensor_val;
+    if(leaf[2] < NUM_SENSORS){
+        sensor_val = Global->csLastTelemetry.reading[leaf[2]];
+    }
+    else if(PSENSOR_IS_DERIVED(leaf[2])){
+        sensor_val = derivedReading(leaf[2]);
+    }
+    else{
+        sensor_val = now;
+    }
+    return (COND_COMPARE[leaf[3]] >> ((sensor_val >= value) + (sensor_val > value))) & 1u;
+}
+
+/*
+ * condProgramEval
+ * INPUT: uint16_t start - offset of the program in csCondProgram
+ *        uint32_t now - csunSatEpoch time the conditions are being checked at
+ *        uint8_t* status - returns COND_STATUS_LEAF + the tag of the leaf that decided the result
+ * OUTPUT: BOOL - result of the program
+ * INFO: The stack is kept as bits of a uint32_t, the top of the stack in bit 0, so every operation is a shift
+ *       and a mask. condProgramLoad checked every instruction, jump and stack depth, so the only thing left to
+ *       check is that the condition points at the start of one of the programs loaded now (see condStarts),
+ *       and the program is then run without any checks. A condition pointing anywhere else is false with a
+ *       status of 0, the same as a condition that's never met.
+ */
+BOOL condProgramEval(uint16_t start, uint32_t now, uint8_t* status){
+    uint8_t const* code = Global->csCondProgram.code;
+    uint16_t pc = start;
+    uint32_t stack = 0;
+    uint8_t tag = 0;
+    if((start >= COND_PROGRAM_SIZE) || !(condStarts[start >> 3] & (1u << (start & 7)))){
+        *status = 0;
+        return false;
+    }
+    for(;;){
+        switch(code[pc]){
+            case COND_LEAF:
+                stack = (stack << 1) | condLeaf(&code[pc], condLeafValue[pc >> 3], now);
+                tag = code[pc+1];
+                pc += COND_LEAF_BYTES;
+                break;
+            case COND_AND:
+                stack = (stack >> 1) & (stack | ~1u);
+                pc++;
+                break;
+            case COND_OR:
+                stack = (stack >> 1) | (stack & 1u);
+                pc++;
+                break;
+            case COND_NOT:
+                stack ^= 1u;
+                pc++;
+                break;
+            case COND_JUMP_FALSE:
+                pc += ((stack & 1u) ? 0 : code[pc+1]) + COND_JUMP_BYTES;
+                break;
+            case COND_JUMP_TRUE:
+                pc += ((stack & 1u) ? code[pc+1] : 0) + COND_JUMP_BYTES;
+                break;
+            default: //COND_END, the loader made sure there is nothing else
+                *status = COND_STATUS_LEAF + tag;
+                return (stack & 1u);
+        }
+    }
+}
+
+/*
+ * condProgramLeaves
+ * INPUT: uint16_t start - offset of the program in csCondProgram
+ *        condition_t* leaves - returns every comparison the program can make
+ *        uint8_t max - room in leaves
+ * OUTPUT: uint8_t - number of leaves, or 0xFF if there are more than max or the program doesn't make sense
+ * INFO: Used by the condition watch (CScondWatch.c) to find everything a program depends on. All leaves are
+ *       listed, not just the ones the last evaluation reached, since any of them could change the result.
+ */
+uint8_t condProgramLeaves(uint16_t start, condition_t* leaves, uint8_t max){
+    uint8_t const* code = Global->csCondProgram.code;
+    uint16_t len = Global->csCondProgram.len;
+    uint16_t pc = start;
+    uint8_t n = 0;
+    while(pc < len){
+        switch(code[pc]){
+            case COND_LEAF:
+                if((pc + COND_LEAF_BYTES > len) || (n == max)){
+                    return 0xFF;
+                }
+                leaves[n].sensor_id = code[pc+2];
+                leaves[n].comparator = code[pc+3];
+                leaves[n].value = ((uint32_t)code[pc+4] << 24) | ((uint32_t)code[pc+5] << 16)
+                                | ((uint32_t)code[pc+6] << 8) | code[pc+7];
+                n++;
+                pc += COND_LEAF_BYTES;
+                break;
+            case COND_AND:
+            case COND_OR:
+            case COND_NOT:
+                pc++;
+                break;
+            case COND_JUMP_FALSE:
+            case COND_JUMP_TRUE:
+                pc += COND_JUMP_BYTES;
+                break;
+            case COND_END:
+                return n;
+            default:
+                return 0xFF;
+        }
+    }
+    return 0xFF;
+}
@@ -0,0 +1,49 @@
+/*
+ * File:   CScondition.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Condition programs for pending command wait and exit conditions, see CScondition.c
+ */
+
+#ifndef CSCONDITION_H
+#define	CSCONDITION_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CSpendingCommand.h"
+
+//condition_t sensor ID whose value is the offset of a condition program instead of a sensor reading
+#define PSENSOR_CONDITION_PROGRAM 253
+
+#define COND_PROGRAM_SIZE  256  //bytes of program storage shared by every program
+#define COND_STACK_DEPTH   32   //deepest the evaluator stack may get
+#define COND_MAX_TAGS      64   //leaf tags are 0 to COND_MAX_TAGS-1
+#define COND_STATUS_LEAF   0x80 //status of a condition decided by a program, COND_STATUS_LEAF + tag of the deciding leaf
+
+#define COND_LEAF_BYTES    8    //COND_LEAF, tag, sensor ID, comparator, value (4 bytes, MSB first)
+#define COND_JUMP_BYTES    2    //COND_JUMP_FALSE or COND_JUMP_TRUE, bytes to skip after the jump
+
+typedef enum{
+    COND_END        = 0, //end of the program, the single value left on the stack is the result
+    COND_LEAF       = 1, //push the result of comparing a sensor reading to a value
+    COND_AND        = 2, //pop two, push both true
+    COND_OR         = 3, //pop two, push either true
+    COND_NOT        = 4, //invert the top of the stack
+    COND_JUMP_FALSE = 5, //skip forward if the top of the stack is false, leaving it there
+    COND_JUMP_TRUE  = 6, //skip forward if the top of the stack is true, leaving it there
+} cond_opcode_t;
+
+typedef struct{
+    uint16_t len;                   //bytes of code in use
+    uint8_t code[COND_PROGRAM_SIZE];
+} cond_program_t;
+
+uint8_t condProgramLoad(uint8_t const* code, uint16_t len);
+void condProgramIndex();
+BOOL condProgramEval(uint16_t start, uint32_t now, uint8_t* status);
+uint8_t condProgramLeaves(uint16_t start, condition_t* leaves, uint8_t max);
+
+#endif	/* CSCONDITION_H */
+
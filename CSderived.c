@@ -0,0 +1,253 @@
+/*
+ * File:   CSderived.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * A condition on a raw reading can be tripped by a single noisy sample. Derived signals give conditions
+ * something steadier to compare: the ground sets up to DERIVED_SIGNALS of them (derivedSet), each the rolling
+ * mean of a sensor over a window of seconds or its change over that many seconds, and a condition refers to
+ * one with sensor ID PSENSOR_DERIVED_FIRST + its index. PSENSOR_BATT_DELTA gives conditions the battery
+ * temperature delta basic telemetry already keeps.
+ *
+ * derivedUpdate is called by the telemetry path each second and only keeps the signals that some loaded
+ * sequence or the condition programs it uses refers to. Each of those costs one add and one subtract for the
+ * running sum, so nothing is spent while no condition uses them. Whenever sequences or programs change the
+ * references are found again by derivedRefsUpdate, which pendingProcess calls from the main loop, so the
+ * telemetry interrupt only reads the resulting mask and never walks the sequences. A signal starts over when
+ * it is first referred to, so for its first window of seconds it covers only the readings since.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CSlogging.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+#include "CScondition.h"
+#include "CScondWatch.h"
+#include "CSpollLog.h"
+#include "CSderived.h"
+
+static struct{
+    uint16_t buf[DERIVED_MAX_WINDOW + 1]; //a delta needs the reading from window seconds ago as well
+    uint32_t sum;   //of the readings in buf
+    uint16_t value; //signal as of the last update
+    uint8_t  pos;   //where the next reading goes, the oldest reading once buf is full
+    uint8_t  count; //readings in buf
+} derived[DERIVED_SIGNALS];
+
+static uint8_t derivedActive;        //bit for each signal a condition refers to, read by the telemetry interrupt
+static BOOL derivedDirty = true;     //references have to be found again, only used by the main loop
+
+/*
+ * derivedReset
+ * INPUT: uint8_t index - derived signal to start over
+ * OUTPUT: none
+ */
+static void derivedReset(uint8_t index){
+    derived[index].sum = 0;
+    derived[index].pos = 0;
+    derived[index].count = 0;
+}
+
+/*
+ * derivedSet
+ * INPUT: uint8_t index - derived signal, 0 to DERIVED_SIGNALS-1
+ *        uint8_t sensor - sensor ID to derive it from
+ *        uint8_t kind - derived_kind_t, DERIVED_OFF to remove it
+ *        uint8_t window - seconds to average over or take the change across
+ * OUTPUT: uint8_t - 0 if it was set, 0xFF if the index is invalid, 0xFE if the signal is invalid
+ * INFO: Sets up one derived signal from the ground. Its history starts over and the cached condition results
+ *       are dropped, since anything already comparing it now compares something else.
+ */
+uint8_t derivedSet(uint8_t index, uint8_t sensor, uint8_t kind, uint8_t window){
+    derived_config_t config;
+    uint8_t rec[4];
+    if(index >= DERIVED_SIGNALS){
+        return 0xFF;
+    }
+    if((kind != DERIVED_OFF) && ((kind > DERIVED_DELTA) || (sensor >= NUM_SENSORS)
+            || (window == 0) || (window > DERIVED_MAX_WINDOW))){
+        return 0xFE;
+    }
+    config.sensor = sensor;
+    config.kind = kind;
+    config.window = window;
+    G_SET(csDerived[index], &config);
+    derivedReset(index);
+    derivedRefsChanged();
+    condWatchInvalidate();
+    rec[0] = index;
+    rec[1] = sensor;
+    rec[2] = kind;
+    rec[3] = window;
+    pollLogAppend(POLL_LOG_DERIVED, rec, sizeof(rec));
+    return 0;
+}
+
+/*
+ * derivedReading
+ * INPUT: uint8_t sensor_id - PSENSOR_DERIVED_FIRST + index, or PSENSOR_BATT_DELTA
+ * OUTPUT: uint16_t - the signal as of the last telemetry
+ * INFO: A signal that hasn't been updated yet reads as the raw reading for a mean and no change for a delta,
+ *       never as 0, so it can't trip a condition that the readings wouldn't.
+ */
+uint16_t derivedReading(uint8_t sensor_id){
+    uint8_t index = sensor_id - PSENSOR_DERIVED_FIRST;
+    derived_config_t const* config;
+    if(sensor_id == PSENSOR_BATT_DELTA){
+        return (uint16_t)(Global->csBasicTelemetry.battDeltaTemp + DERIVED_BIAS);
+    }
+    if(!PSENSOR_IS_DERIVED(sensor_id)){
+        return 0;
+    }
+    if((derivedActive & (1 << index)) && (derived[index].count > 0)){
+        return derived[index].value;
+    }
+    config = &Global->csDerived[index];
+    if((config->kind == DERIVED_MEAN) && (config->sensor < NUM_SENSORS)){
+        return Global->csLastTelemetry.reading[config->sensor];
+    }
+    return DERIVED_BIAS;
+}
+
+/*
+ * derivedRefsChanged
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called whenever a sequence or the condition programs change, so derivedRefsUpdate finds out again
+ *       which signals are referred to. Only marks them, so it can be called with interrupts held off.
+ */
+void derivedRefsChanged(){
+    derivedDirty = true;
+}
+
+/*
+ * derivedScan
+ * INPUT: condition_t const* cond - a condition
+ * OUTPUT: uint8_t - bit for each derived signal it refers to, including through a condition program
+ */
+static uint8_t derivedScan(condition_t const* cond){
+    uint8_t mask = 0;
+    if(cond->sensor_id == PSENSOR_CONDITION_PROGRAM){
+        condition_t leaves[COND_PROGRAM_SIZE / COND_LEAF_BYTES]; //most leaves a program can hold
+        uint8_t n = condProgramLeaves(cond->value, leaves, sizeof(leaves) / sizeof(leaves[0]));
+        uint8_t i;
+        for(i = 0; (n != 0xFF) && (i < n); i++){
+            mask |= derivedScan(&leaves[i]); //leaves can't refer to another program
+        }
+    }
+    else if((cond->sensor_id >= PSENSOR_DERIVED_FIRST) && (cond->sensor_id < PSENSOR_DERIVED_FIRST + DERIVED_SIGNALS)){
+        mask = 1 << (cond->sensor_id - PSENSOR_DERIVED_FIRST);
+    }
+    return mask;
+}
+
+/*
+ * derivedScanConds
+ * INPUT: conditions_t const* cond - exit or wait conditions
+ * OUTPUT: uint8_t - bit for each derived signal they refer to
+ */
+static uint8_t derivedScanConds(conditions_t const* cond){
+    uint8_t mask = derivedScan(&cond->left);
+    if(cond->op != JUST){
+        mask |= derivedScan(&cond->right);
+    }
+    return mask;
+}
+
+/*
+ * derivedRefs
+ * INPUT: none
+ * OUTPUT: uint8_t - bit for each configured derived signal referred to by a loaded sequence
+ */
+static uint8_t derivedRefs(){
+    PendCmdQueue queueTemp;
+    seq_command_t cmd;
+    uint8_t mask = 0;
+    uint8_t slot;
+    uint8_t i;
+    for(slot = 0; slot < NUM_SEQUENCES; slot++){
+        if(PendCmdQueue_Count(&Global->csSequence[slot].cmd_queue) == 0){
+            continue;
+        }
+        mask |= derivedScanConds(&Global->csSequence[slot].exit);
+        memcpy(&queueTemp, &Global->csSequence[slot].cmd_queue, sizeof(queueTemp));
+        while(PendCmdQueue_Count(&queueTemp) > 0){
+            PendCmdQueue_Dequeue(&queueTemp, &cmd);
+            mask |= derivedScanConds(&cmd.wait);
+        }
+    }
+    for(i = 0; i < DERIVED_SIGNALS; i++){
+        derived_config_t const* config = &Global->csDerived[i];
+        if((config->kind == DERIVED_OFF) || (config->kind > DERIVED_DELTA) || (config->sensor >= NUM_SENSORS)
+                || (config->window == 0) || (config->window > DERIVED_MAX_WINDOW)){
+            mask &= ~(1 << i); //not set up, nothing to keep
+        }
+    }
+    return mask;
+}
+
+/*
+ * derivedRefsUpdate
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called from the main loop. If the references may have changed since the last call, the sequences are
+ *       scanned with interrupts enabled, then the signals derivedUpdate keeps are switched over with them held off.
+ */
+void derivedRefsUpdate(){
+    cpu_priority_t priority;
+    uint8_t refs;
+    uint8_t i;
+    if(!derivedDirty){
+        return;
+    }
+    derivedDirty = false;
+    refs = derivedRefs();
+    priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY); //derivedUpdate uses the history and the mask
+    for(i = 0; i < DERIVED_SIGNALS; i++){
+        if((refs & ~derivedActive) & (1 << i)){
+            derivedReset(i); //history from when it was last used would be stale
+        }
+    }
+    derivedActive = refs;
+    Metal_SetCPUPriority(priority);
+}
+
+/*
+ * derivedUpdate
+ * INPUT: uint16_t const* readings - the new csLastTelemetry readings
+ * OUTPUT: none
+ * INFO: Called each time telemetry is recorded, before the condition watch is told about the readings.
+ *       Each referenced signal takes in its new reading and drops the one that fell out of its window.
+ */
+void derivedUpdate(uint16_t const* readings){
+    uint8_t i;
+    for(i = 0; i < DERIVED_SIGNALS; i++){
+        derived_config_t const* config = &Global->csDerived[i];
+        uint8_t len;
+        uint16_t val;
+        if(!(derivedActive & (1 << i))){
+            continue;
+        }
+        len = config->window + ((config->kind == DERIVED_DELTA) ? 1 : 0);
+        val = readings[config->sensor];
+        if(derived[i].count == len){
+            derived[i].sum -= derived[i].buf[derived[i].pos];
+        }
+        else{
+            derived[i].count++;
+        }
+        derived[i].buf[derived[i].pos] = val;
+        derived[i].sum += val;
+        derived[i].pos = (derived[i].pos + 1) % len;
+        if(config->kind == DERIVED_MEAN){
+            derived[i].value = derived[i].sum / derived[i].count;
+        }
+        else{
+            uint16_t oldest = (derived[i].count == len) ? derived[i].buf[derived[i].pos] : derived[i].buf[0];
+            derived[i].value = val - oldest + DERIVED_BIAS;
+        }
+    }
+}
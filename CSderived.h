@@ -0,0 +1,44 @@
+/*
+ * File:   CSderived.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Derived signals (rolling means and deltas of sensor readings) that conditions can compare, see CSderived.c
+ */
+
+#ifndef CSDERIVED_H
+#define	CSDERIVED_H
+
+#include <stdint.h>
+#include "types.h"
+
+//condition_t sensor IDs of the derived signals
+#define PSENSOR_DERIVED_FIRST 240 //derived signal 0, up to PSENSOR_DERIVED_FIRST + DERIVED_SIGNALS - 1
+#define PSENSOR_BATT_DELTA    248 //csBasicTelemetry.battDeltaTemp + DERIVED_BIAS
+#define PSENSOR_IS_DERIVED(id) (((id) >= PSENSOR_DERIVED_FIRST) && ((id) <= PSENSOR_BATT_DELTA))
+
+#define DERIVED_SIGNALS    8      //derived signals the ground can set up
+#define DERIVED_MAX_WINDOW 32     //longest window, in seconds of telemetry
+#define DERIVED_BIAS       0x8000 //added to deltas so a negative change still compares as an unsigned value
+
+typedef enum{
+    DERIVED_OFF   = 0,
+    DERIVED_MEAN  = 1, //mean of the last window readings
+    DERIVED_DELTA = 2, //the reading now minus the reading window seconds ago, + DERIVED_BIAS
+} derived_kind_t;
+
+typedef struct{
+    uint8_t sensor; //sensor ID the signal is derived from, below NUM_SENSORS
+    uint8_t kind;   //derived_kind_t
+    uint8_t window; //seconds, 1 to DERIVED_MAX_WINDOW
+} derived_config_t;
+
+uint8_t derivedSet(uint8_t index, uint8_t sensor, uint8_t kind, uint8_t window);
+uint16_t derivedReading(uint8_t sensor_id);
+void derivedRefsChanged();
+void derivedRefsUpdate();
+void derivedUpdate(uint16_t const* readings);
+
+#endif	/* CSDERIVED_H */
+
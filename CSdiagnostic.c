@@ -0,0 +1,322 @@
+/*
+ * File:   CSdiagnostic.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * The daily diagnostic used to be one call to CubeSat_SpawnDiagnostician from the DIAGNOSTIC_CHECK state, and
+ * was left disabled since nothing else could run until it returned: the telemetry events, sequences and the
+ * beacon timer would all wait on it. Now DIAGNOSTIC_CHECK only starts it, once a day, and it is run as a
+ * sequence of checks, each taking small steps, one step for each status monitoring pass in ALL_QUIET
+ * (see statusMonitoringStateMachine). Events are handled before each pass, so telemetry still goes first, and
+ * a diagnostic that isn't done when the beacon is due picks up where it stopped in the next ALL_QUIET.
+ *
+ * The checks are:
+ * - configuration: a Fletcher-16 over the sequences, condition programs, derived signals and beacon layout
+ *   the ground uploaded, DIAG_SUM_SLICE bytes a step. The ground can compare it with the check of what
+ *   it sent, and DIAG_CONFIG_CHANGED is set when it differs from the last diagnostic's (or basic telemetry
+ *   was cleared since).
+ * - SD card: a pattern that depends on the day is written to DIAG_SD_FILE in one step and read back and
+ *   compared in the next. It waits while a job has the card (see CSjobs.c).
+ * - sensors: DIAG_SENSOR_SLICE sensors a step, each failing if its basic telemetry holds a reading out of
+ *   the ADC's range or has been at full scale since basic telemetry was cleared.
+ *
+ * When all are done the result bits, the configuration check and the time go into basic telemetry, and each
+ * failed check takes an anomaly slot (see CSdiagnostic.h for the codes). The day is only recorded then, so a
+ * diagnostic cut short by a reset runs again. The progress itself is not kept in the globals.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "debug.h"
+#include "CSopenSourceFAT.h"
+#include "CSlogging.h"
+#include "csBasicTelemetry.h"
+#include "CSjobs.h"
+#include "CSdiagnostic.h"
+
+#define DIAG_SUM_SLICE    256       //configuration bytes summed in one step
+#define DIAG_SENSOR_SLICE 11        //sensors checked in one step
+#define DIAG_SD_FILE      "DIAG.BIN"
+#define DIAG_SD_BYTES     512       //one card block
+#define DIAG_SD_CHUNK     64        //bytes written or compared at a time, kept on the stack
+#define DIAG_SENSOR_MAX   0x0FFF    //readings are 12 bit
+
+typedef enum{
+    DIAG_STEP_IDLE = 0, //not running
+    DIAG_STEP_CONFIG,   //summing the configuration
+    DIAG_STEP_SD_WRITE, //writing the pattern
+    DIAG_STEP_SD_READ,  //reading it back
+    DIAG_STEP_SENSORS,  //checking the sensors
+    DIAG_STEP_REPORT,   //storing the results
+} diag_step_t;
+
+typedef struct{
+    global_ptr_t offset;
+    uint16_t size;
+} diag_area_t;
+
+//parts of the globals the ground uploads, summed in this order
+static const diag_area_t DIAG_AREAS[] = {
+    {G_OFFSET(csSequence),      sizeof(((GlobalX*)NULL)->csSequence)},
+    {G_OFFSET(csCondProgram),   sizeof(cond_program_t)},
+    {G_OFFSET(csDerived),       sizeof(((GlobalX*)NULL)->csDerived)},
+    {G_OFFSET(csBeacon.layout), sizeof(((GlobalX*)NULL)->csBeacon.layout)},
+};
+#define DIAG_NUM_AREAS (sizeof(DIAG_AREAS) / sizeof(DIAG_AREAS[0]))
+
+static struct{
+    diag_step_t step;
+    uint8_t     day;      //day it was started for
+    uint8_t     result;   //DIAG_FAIL_ and DIAG_CONFIG_CHANGED bits so far
+    uint8_t     area;     //DIAG_AREAS entry being summed, or sensor being checked
+    uint16_t    offset;   //bytes of that area summed so far
+    uint16_t    sum;      //running Fletcher-16 of the configuration
+    uint8_t     sdDetail; //DIAG_SD_ detail of the SD failure
+    uint8_t     sensor;   //first sensor that failed
+} diag;
+
+/*
+ * diagSum
+ * INPUT: uint16_t* sum - running Fletcher-16, started at 0
+ *        uint8_t const* data - bytes to add
+ *        uint16_t len - number of bytes
+ * OUTPUT: none
+ */
+static void diagSum(uint16_t* sum, uint8_t const* data, uint16_t len){
+    uint16_t sum1 = (*sum & 0xFF);
+    uint16_t sum2 = (*sum >> 8);
+    while(len-- > 0){
+        sum1 = (sum1 + *data++) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    *sum = ((sum2 << 8) | sum1);
+}
+
+/*
+ * diagPattern
+ * INPUT: uint8_t* buf - filled with the pattern
+ *        uint16_t at - offset in the file of buf[0]
+ * OUTPUT: none
+ * INFO: Fills DIAG_SD_CHUNK bytes. The pattern depends on the day, so a file left from an earlier diagnostic
+ *       doesn't read back as this one's.
+ */
+static void diagPattern(uint8_t* buf, uint16_t at){
+    uint8_t i;
+    for(i = 0; i < DIAG_SD_CHUNK; i++){
+        buf[i] = (uint8_t)(((at + i) * 31) + (diag.day * 13) + 0x5A);
+    }
+}
+
+/*
+ * diagFailSD
+ * INPUT: uint8_t detail - DIAG_SD_ detail of what failed
+ * OUTPUT: none
+ */
+static void diagFailSD(uint8_t detail){
+    diag.result |= DIAG_FAIL_SD;
+    diag.sdDetail = detail;
+    diag.step = DIAG_STEP_SENSORS;
+    diag.area = 0;
+}
+
+/*
+ * diagConfig
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sums up to DIAG_SUM_SLICE bytes of the configuration, moving on to the SD card once all are summed.
+ */
+static void diagConfig(){
+    uint16_t left = DIAG_SUM_SLICE;
+    while((left > 0) && (diag.area < DIAG_NUM_AREAS)){
+        uint16_t len = DIAG_AREAS[diag.area].size - diag.offset;
+        if(len > left){
+            len = left;
+        }
+        diagSum(&diag.sum, (uint8_t const*)Global + DIAG_AREAS[diag.area].offset + diag.offset, len);
+        diag.offset += len;
+        left -= len;
+        if(diag.offset >= DIAG_AREAS[diag.area].size){
+            diag.area++;
+            diag.offset = 0;
+        }
+    }
+    if(diag.area >= DIAG_NUM_AREAS){
+        if(diag.sum != Global->csBasicTelemetry.diagConfigCheck){
+            diag.result |= DIAG_CONFIG_CHANGED;
+        }
+        diag.step = DIAG_STEP_SD_WRITE;
+    }
+}
+
+/*
+ * diagSDWrite
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Writes the pattern to DIAG_SD_FILE.
+ */
+static void diagSDWrite(){
+    uint8_t buf[DIAG_SD_CHUNK];
+    uint16_t at;
+    BOOL ok;
+    FSFILE* file = FSfopen(DIAG_SD_FILE, "w");
+    if(file == NULL){
+        diagFailSD(DIAG_SD_WRITE);
+        return;
+    }
+    ok = true;
+    for(at = 0; ok && (at < DIAG_SD_BYTES); at += DIAG_SD_CHUNK){
+        diagPattern(buf, at);
+        ok = (FSfwrite(buf, DIAG_SD_CHUNK, 1, file) == 1);
+    }
+    ok &= (FSfclose(file) == 0);
+    if(!ok){
+        diagFailSD(DIAG_SD_WRITE);
+        return;
+    }
+    diag.step = DIAG_STEP_SD_READ;
+}
+
+/*
+ * diagSDRead
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Reads DIAG_SD_FILE back and compares it with the pattern, then removes it.
+ */
+static void diagSDRead(){
+    uint8_t expect[DIAG_SD_CHUNK];
+    uint8_t buf[DIAG_SD_CHUNK];
+    uint16_t at;
+    uint8_t detail = 0;
+    FSFILE* file = FSfopen(DIAG_SD_FILE, "r");
+    if(file == NULL){
+        diagFailSD(DIAG_SD_READ);
+        return;
+    }
+    for(at = 0; (detail == 0) && (at < DIAG_SD_BYTES); at += DIAG_SD_CHUNK){
+        if(FSfread(buf, DIAG_SD_CHUNK, 1, file) != 1){
+            detail = DIAG_SD_READ;
+        }
+        else{
+            diagPattern(expect, at);
+            if(memcmp(buf, expect, DIAG_SD_CHUNK) != 0){
+                detail = DIAG_SD_MISMATCH;
+            }
+        }
+    }
+    FSfclose(file);
+    FSremove(DIAG_SD_FILE);
+    if(detail != 0){
+        diagFailSD(detail);
+        return;
+    }
+    diag.step = DIAG_STEP_SENSORS;
+    diag.area = 0;
+}
+
+/*
+ * diagSensors
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Checks up to DIAG_SENSOR_SLICE sensors against their basic telemetry. Sensors with no readings since
+ *       it was cleared are skipped.
+ */
+static void diagSensors(){
+    uint8_t end = diag.area + DIAG_SENSOR_SLICE;
+    if(end > NUM_SENSORS){
+        end = NUM_SENSORS;
+    }
+    for(; diag.area < end; diag.area++){
+        csSingleBasicTelemetry const* sensor = &Global->csBasicTelemetry.csSingleTelemetry[diag.area];
+        if(sensor->n == 0){
+            continue;
+        }
+        if((sensor->hiVal > DIAG_SENSOR_MAX) || (sensor->lowVal >= DIAG_SENSOR_MAX)){
+            if(!(diag.result & DIAG_FAIL_SENSOR)){
+                diag.sensor = diag.area;
+            }
+            diag.result |= DIAG_FAIL_SENSOR;
+        }
+    }
+    if(diag.area >= NUM_SENSORS){
+        diag.step = DIAG_STEP_REPORT;
+    }
+}
+
+/*
+ * diagReport
+ * INPUT: none
+ * OUTPUT: diag_status_t - DIAG_PASSED or DIAG_FAILED
+ * INFO: Stores the results in basic telemetry, each failed check in an anomaly slot, and records the day as done.
+ */
+static diag_status_t diagReport(){
+    uint32_t now = Global->csLastTelemetry.epoch;
+    dprintf("Diagnostic done: %x\r\n", diag.result);
+    storeDiagBasicTelemetry(diag.result, diag.sum, now);
+    if(diag.result & DIAG_FAIL_SD){
+        storeAnomalyBasicTelemetry(DIAG_ANOMALY_SD | diag.sdDetail, now);
+    }
+    if(diag.result & DIAG_FAIL_SENSOR){
+        storeAnomalyBasicTelemetry(DIAG_ANOMALY_SENSOR | diag.sensor, now);
+    }
+    G_SET(csState.diagDay, &diag.day);
+    diag.step = DIAG_STEP_IDLE;
+    return (diag.result & DIAG_FAIL_MASK) ? DIAG_FAILED : DIAG_PASSED;
+}
+
+/*
+ * diagStart
+ * INPUT: uint8_t day - day the diagnostic is for, recorded in csState.diagDay once it finishes
+ * OUTPUT: none
+ * INFO: Called from DIAGNOSTIC_CHECK. Starts the checks over, the steps are taken by diagStep.
+ */
+void diagStart(uint8_t day){
+    memset(&diag, 0, sizeof(diag));
+    diag.day = day;
+    diag.step = DIAG_STEP_CONFIG;
+}
+
+/*
+ * diagRunning
+ * INPUT: none
+ * OUTPUT: BOOL - true from diagStart until the results are reported
+ */
+BOOL diagRunning(){
+    return (diag.step != DIAG_STEP_IDLE);
+}
+
+/*
+ * diagStep
+ * INPUT: none
+ * OUTPUT: diag_status_t - DIAG_IDLE if there was nothing to do, DIAG_BUSY after a step, or how it ended
+ * INFO: Called from ALL_QUIET once each pass with no event to handle. Takes one step, which is at most
+ *       DIAG_SUM_SLICE bytes summed, one card block written or read, or DIAG_SENSOR_SLICE sensors checked.
+ *       The SD steps wait while a job has the card.
+ */
+diag_status_t diagStep(){
+    switch(diag.step){
+        case DIAG_STEP_CONFIG:
+            diagConfig();
+            break;
+        case DIAG_STEP_SD_WRITE:
+            if(jobSDBusy()){
+                return DIAG_IDLE; //nothing to do until the job is done
+            }
+            diagSDWrite();
+            break;
+        case DIAG_STEP_SD_READ:
+            if(jobSDBusy()){
+                return DIAG_IDLE;
+            }
+            diagSDRead();
+            break;
+        case DIAG_STEP_SENSORS:
+            diagSensors();
+            break;
+        case DIAG_STEP_REPORT:
+            return diagReport();
+        default:
+            return DIAG_IDLE;
+    }
+    return DIAG_BUSY;
+}
@@ -0,0 +1,42 @@
+/*
+ * File:   CSdiagnostic.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * The daily diagnostic, run in small steps while status monitoring is all quiet, see CSdiagnostic.c
+ */
+
+#ifndef CSDIAGNOSTIC_H
+#define	CSDIAGNOSTIC_H
+
+#include <stdint.h>
+#include "types.h"
+
+//bits of the result kept in basic telemetry (see storeDiagBasicTelemetry), a failed check sets its bit
+#define DIAG_FAIL_SD        0x01 //the pattern written to the SD card didn't read back
+#define DIAG_FAIL_SENSOR    0x02 //a sensor's readings are out of range or stuck at full scale
+#define DIAG_FAIL_MASK      0x7F
+#define DIAG_CONFIG_CHANGED 0x80 //not a failure: the uploaded configuration's check changed since the last diagnostic
+
+//anomaly slot info of a failed check (see storeAnomalyBasicTelemetry), the low byte is the detail
+#define DIAG_ANOMALY_SD     0xD100 //low byte is one of the DIAG_SD_ details below
+#define DIAG_ANOMALY_SENSOR 0xD200 //low byte is the first sensor that failed
+
+#define DIAG_SD_WRITE    1 //the pattern file couldn't be written
+#define DIAG_SD_READ     2 //the pattern file couldn't be read back
+#define DIAG_SD_MISMATCH 3 //it read back different
+
+typedef enum{
+    DIAG_IDLE = 0, //no diagnostic running
+    DIAG_BUSY,     //took a step, there is more to do
+    DIAG_PASSED,   //finished, every check passed
+    DIAG_FAILED,   //finished, at least one check failed and was reported
+} diag_status_t;
+
+void diagStart(uint8_t day);
+BOOL diagRunning();
+diag_status_t diagStep();
+
+#endif	/* CSDIAGNOSTIC_H */
+
@@ -0,0 +1,151 @@
+/*
+ * File:   CSdownlink.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Responses, response poll chunks and telemetry stream chunks used to go down in a radio frame each, and
+ * every frame carries the AX.25 header and FCS and the radio header, close to 30 bytes, whatever its size.
+ * In a busy command session most items are only a few bytes, so most of what was sent was framing.
+ *
+ * Now items are packed one after another into a frame of up to DL_MTU bytes, each behind a two byte header:
+ * its dl_type_t and its length. The frame goes to the radio, through the function given to dlInit, as soon as
+ * the next item doesn't fit, or DL_FLUSH_MS after its first item was packed so a lone item doesn't wait long.
+ * The deadline is a timer on the timer wheel, whose callback pushes EVENT_DOWNLINK_FLUSH so the frame is
+ * sent from the main loop like everything else is (see CSevents.c). Link sessions run in COMMAND_RESPONSE, whose
+ * state machine has to dispatch events for that to happen; in case it doesn't yet, a frame whose deadline has
+ * passed is also sent by the next dlQueue.
+ *
+ * Nothing in this tree sends through it yet: the link layer and radio driver are outside it. To switch over, the
+ * link calls dlInit with the radio's frame send function when a session starts, hands each response, poll chunk
+ * and stream chunk to dlQueue instead of sending it in a frame of its own, and calls dlFlushNow before it gives the
+ * link up. Until then dl.send stays NULL and dlQueue refuses everything, so nothing changes.
+ *
+ * Only called from the main loop.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "CStimerWheel.h"
+#include "CSevents.h"
+#include "CSdownlink.h"
+
+static struct{
+    dl_send_t send;
+    uint8_t   frame[DL_MTU];
+    uint16_t  len;   //bytes packed so far
+    uint8_t   items; //items packed so far
+} dl;
+
+static timer_wheel_t dlTimer; //running while the frame has items, see DL_FLUSH_MS
+static dl_stats_t dlStat;
+
+/*
+ * dlDeadline
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Timer wheel callback, from the timer interrupt. The frame is sent by the event's handler.
+ */
+static void dlDeadline(){
+    eventPush(EVENT_DOWNLINK_FLUSH, 0);
+}
+
+/*
+ * dlSend
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sends the frame if it has anything in it and starts a new one.
+ */
+static void dlSend(){
+    if(dl.items == 0){
+        return;
+    }
+    timerWheelCancel(&dlTimer);
+    dl.send(dl.frame, dl.len);
+    dlStat.frames++;
+    dlStat.items += dl.items;
+    dlStat.bytes += dl.len;
+    dl.len = 0;
+    dl.items = 0;
+}
+
+/*
+ * dlInit
+ * INPUT: dl_send_t send - hands a packed frame to the radio
+ * OUTPUT: none
+ * INFO: Drops anything packed so far.
+ */
+void dlInit(dl_send_t send){
+    timerWheelCancel(&dlTimer);
+    dl.send = send;
+    dl.len = 0;
+    dl.items = 0;
+}
+
+/*
+ * dlQueue
+ * INPUT: dl_type_t type - what the item is
+ *        uint8_t const* data - the item, copied
+ *        uint8_t len - its length, at most DL_ITEM_MAX
+ * OUTPUT: BOOL - false if it is too long or there is no radio to send it to
+ * INFO: Packs the item into the frame, sending the frame first if the item doesn't fit or its deadline has
+ *       passed without EVENT_DOWNLINK_FLUSH being handled. The first item of a frame starts the deadline.
+ */
+BOOL dlQueue(dl_type_t type, uint8_t const* data, uint8_t len){
+    if((dl.send == NULL) || (len > DL_ITEM_MAX)){
+        return false;
+    }
+    dlFlush(); //only sends if the deadline has passed
+    if(dl.len + DL_ITEM_HEADER + len > DL_MTU){
+        dlSend();
+    }
+    dl.frame[dl.len] = type;
+    dl.frame[dl.len + 1] = len;
+    memcpy(&dl.frame[dl.len + DL_ITEM_HEADER], data, len);
+    dl.len += DL_ITEM_HEADER + len;
+    dl.items++;
+    if(dl.len > DL_MTU - DL_ITEM_HEADER){
+        dlSend(); //not even an empty item fits
+    }
+    else if(dl.items == 1){
+        timerWheelStart(&dlTimer, DL_FLUSH_MS, &dlDeadline);
+    }
+    return true;
+}
+
+/*
+ * dlFlush
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sends whatever has been packed once its deadline has passed, for EVENT_DOWNLINK_FLUSH and dlQueue.
+ */
+void dlFlush(){
+    if((dl.items == 0) || timerWheelPending(&dlTimer)){
+        return; //already sent because it filled up, or not due yet
+    }
+    dlStat.deadlines++;
+    dlSend();
+}
+
+/*
+ * dlFlushNow
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sends whatever has been packed without waiting for the deadline, for when the link is about to be given up.
+ */
+void dlFlushNow(){
+    dlSend();
+}
+
+/*
+ * dlStats
+ * INPUT: dl_stats_t* stats - returns the counts so far
+ *        BOOL reset - true to start counting again
+ * OUTPUT: none
+ */
+void dlStats(dl_stats_t* stats, BOOL reset){
+    *stats = dlStat;
+    if(reset){
+        memset(&dlStat, 0, sizeof(dlStat));
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * File:   CSdownlink.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Packs small downlink items into shared radio frames, see CSdownlink.c
+ */
+
+#ifndef CSDOWNLINK_H
+#define	CSDOWNLINK_H
+
+#include <stdint.h>
+#include "types.h"
+
+#define DL_MTU         255 //payload bytes of one radio frame
+#define DL_ITEM_HEADER 2   //type and length before each item
+#define DL_ITEM_MAX    (DL_MTU - DL_ITEM_HEADER)
+#define DL_FLUSH_MS    300 //longest an item waits for others to share its frame
+
+//type byte of an item, so the ground can split a frame back up
+typedef enum{
+    DL_RESPONSE = 1, //response to a command
+    DL_POLL,         //chunk of the response poll
+    DL_TELEMETRY,    //chunk of a telemetry stream
+    DL_CHUNK,        //numbered chunk of a selective repeat stream, see CSarq.c
+} dl_type_t;
+
+//hands one packed frame to the radio
+typedef void (*dl_send_t)(uint8_t const* frame, uint16_t len);
+
+typedef struct{
+    uint32_t frames;    //frames sent
+    uint32_t items;     //items packed into them
+    uint32_t bytes;     //bytes sent, headers included
+    uint32_t deadlines; //frames sent because DL_FLUSH_MS ran out rather than because they were full
+} dl_stats_t;
+
+void dlInit(dl_send_t send);
+BOOL dlQueue(dl_type_t type, uint8_t const* data, uint8_t len);
+void dlFlush();
+void dlFlushNow();
+void dlStats(dl_stats_t* stats, BOOL reset);
+
+#endif	/* CSDOWNLINK_H */
+
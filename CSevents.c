@@ -0,0 +1,197 @@
+/*
+ * File:   CSevents.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * The telemetry interrupt used to tell the main loop about new readings by switching status monitoring into
+ * PENDING_PROCESS for one pass, and wrote the telemetry buffer to the SD card itself. Now interrupts push
+ * events instead and the main loop handles them, highest priority first, whichever main state it is in.
+ *
+ * The state machine of every main state has to start each pass by calling eventDispatch, and end the pass
+ * there if it handled an event, so events are handled at least once per pass of the main loop:
+ * - STATUS_MONITORING does so in statusMonitoringStateMachine;
+ * - COMMAND_RESPONSE, SAFE_HOLD and ANOMALY have to do the same in their own state machines. Without it the
+ *   sequences don't run and neither telemetry nor downlink frames are flushed while the satellite is in them,
+ *   and a link session in COMMAND_RESPONSE needs EVENT_DOWNLINK_FLUSH (see CSdownlink.c) in particular.
+ *
+ * Each kind of event has its own queue of EVENT_QUEUE_SIZE entries, and a kind is only ever pushed by one
+ * producer (see event_kind_t), while only the main loop takes events off. So each queue is single producer,
+ * single consumer: the producer only writes head and the consumer only writes tail, an entry is written before
+ * head moves past it and read before tail does, and neither side ever has to hold interrupts off. A compiler
+ * barrier keeps the entry and the index stores in that order; on this single core that is all it takes.
+ *
+ * eventStats keeps how many events of each kind were handled, merged or dropped. Kinds whose handler always works from the latest state, like telemetry, are merged: pushing one while one
+ * is already waiting doesn't add another.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CSlogging.h"
+#include "CSpendingProcess.h"
+#include "CSjobs.h"
+#include "CSdownlink.h"
+#include "CStimerWheel.h"
+#include "CSpollLog.h"
+#include "CSevents.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+typedef struct{
+    void (*handler)(uint16_t arg);
+    BOOL merge; //one waiting event stands for any pushed after it
+} event_entry_t;
+
+static void eventTelemetry(uint16_t arg);
+static void eventDownlinkFlush(uint16_t arg);
+static void eventFlushDue(uint16_t arg);
+static void eventJobStep(uint16_t arg);
+static void eventPollLog(uint16_t arg);
+
+static const event_entry_t EVENT_TABLE[NUM_EVENTS] = {
+    [EVENT_TELEMETRY]      = {&eventTelemetry,     true},
+    [EVENT_DOWNLINK_FLUSH] = {&eventDownlinkFlush, true},
+    [EVENT_FLUSH_DUE]      = {&eventFlushDue,      true},
+    [EVENT_FLUSH_TICK]     = {&eventFlushDue,      true},
+    [EVENT_JOB_STEP]       = {&eventJobStep,       true},
+    [EVENT_POLL_LOG]       = {&eventPollLog,       true},
+};
+
+static struct{
+    uint16_t arg[EVENT_QUEUE_SIZE];
+    volatile uint8_t head; //next entry to push to, only written by the producer
+    volatile uint8_t tail; //next entry to take, only written by the consumer
+} eventQueue[NUM_EVENTS];
+
+static event_stats_t eventStat[NUM_EVENTS];
+
+/*
+ * eventTelemetry
+ * INPUT: uint16_t arg - unused
+ * OUTPUT: none
+ * INFO: New readings were recorded, give the sequences their once a second step. Also makes sure the timer
+ *       wheel still has the hardware timer.
+ */
+static void eventTelemetry(uint16_t arg){
+    timerWheelCheck();
+    pendingProcess();
+}
+
+/*
+ * eventDownlinkFlush
+ * INPUT: uint16_t arg - unused
+ * OUTPUT: none
+ */
+static void eventDownlinkFlush(uint16_t arg){
+    dlFlush();
+}
+
+/*
+ * eventFlushDue
+ * INPUT: uint16_t arg - unused
+ * OUTPUT: none
+ */
+static void eventFlushDue(uint16_t arg){
+    flushTelemetryToSD();
+}
+
+/*
+ * eventJobStep
+ * INPUT: uint16_t arg - unused
+ * OUTPUT: none
+ * INFO: Background jobs take one step for each event, and push the next one while they have more to do.
+ */
+static void eventJobStep(uint16_t arg){
+    if(jobsRun()){
+        eventPush(EVENT_JOB_STEP, 0);
+    }
+}
+
+/*
+ * eventPollLog
+ * INPUT: uint16_t arg - unused
+ * OUTPUT: none
+ */
+static void eventPollLog(uint16_t arg){
+    pollLogFlush();
+}
+
+/*
+ * eventPush
+ * INPUT: event_kind_t kind - what happened, only ever pushed from its one producer
+ *        uint16_t arg - passed to the handler
+ * OUTPUT: BOOL - false if the queue for this kind was full and the event was dropped
+ * INFO: Safe to call from an interrupt without holding off others, as long as each kind has one producer.
+ */
+BOOL eventPush(event_kind_t kind, uint16_t arg){
+    uint8_t head = eventQueue[kind].head;
+    uint8_t next = (head + 1) & EVENT_QUEUE_MASK;
+    if(EVENT_TABLE[kind].merge && (head != eventQueue[kind].tail)){
+        eventStat[kind].merged++;
+        return true;
+    }
+    if(next == eventQueue[kind].tail){
+        eventStat[kind].dropped++;
+        return false;
+    }
+    eventQueue[kind].arg[head] = arg;
+    __asm__ volatile("" ::: "memory"); //the entry is written before head moves past it
+    eventQueue[kind].head = next; //only now can the consumer see it
+    return true;
+}
+
+/*
+ * eventPending
+ * INPUT: none
+ * OUTPUT: BOOL - true if any event is waiting to be handled
+ */
+BOOL eventPending(){
+    uint8_t kind;
+    for(kind = 0; kind < NUM_EVENTS; kind++){
+        if(eventQueue[kind].head != eventQueue[kind].tail){
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * eventDispatch
+ * INPUT: none
+ * OUTPUT: BOOL - false if there was nothing to handle
+ * INFO: Called at the start of each pass by the state machine of every main state, see above. Takes the oldest
+ *       event of the highest priority kind waiting and runs its handler. Only one event is handled per call so
+ *       the caller's pass stays short.
+ */
+BOOL eventDispatch(){
+    uint8_t kind;
+    for(kind = 0; kind < NUM_EVENTS; kind++){
+        uint8_t tail = eventQueue[kind].tail;
+        if(tail != eventQueue[kind].head){
+            uint16_t arg = eventQueue[kind].arg[tail];
+            __asm__ volatile("" ::: "memory"); //the entry is read before tail moves past it
+            eventQueue[kind].tail = (tail + 1) & EVENT_QUEUE_MASK; //the entry is copied, the producer may reuse it
+            eventStat[kind].count++;
+            EVENT_TABLE[kind].handler(arg);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * eventStats
+ * INPUT: event_kind_t kind - kind of event
+ *        event_stats_t* stats - returns its counts so far
+ *        BOOL reset - true to start counting again
+ * OUTPUT: none
+ */
+void eventStats(event_kind_t kind, event_stats_t* stats, BOOL reset){
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY); //merged and dropped belong to the producer
+    *stats = eventStat[kind];
+    if(reset){
+        memset(&eventStat[kind], 0, sizeof(eventStat[kind]));
+    }
+    Metal_SetCPUPriority(priority);
+}
@@ -0,0 +1,41 @@
+/*
+ * File:   CSevents.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Events handed from the interrupts to the main loop in priority order, see CSevents.c
+ */
+
+#ifndef CSEVENTS_H
+#define	CSEVENTS_H
+
+#include <stdint.h>
+#include "types.h"
+
+#define EVENT_QUEUE_SIZE 8 //entries of each priority's queue, a power of two, one is always left empty
+
+//in priority order, highest first, each pushed by only one producer
+typedef enum{
+    EVENT_TELEMETRY = 0,  //telemetry interrupt: new readings, run the sequences
+    EVENT_DOWNLINK_FLUSH, //timer interrupt: a downlink frame has waited long enough, send it (see CSdownlink.c)
+    EVENT_FLUSH_DUE,      //telemetry interrupt: the telemetry buffer should be written to the SD card
+    EVENT_FLUSH_TICK,     //flush timer interrupt (startFlushToSD): the same, on the timer's schedule
+    EVENT_JOB_STEP,       //main loop: a background job has a step to take
+    EVENT_POLL_LOG,       //main loop: poll log records are waiting to be written (see CSpollLog.c)
+    NUM_EVENTS
+} event_kind_t;
+
+typedef struct{
+    uint32_t count;      //events handled
+    uint32_t merged;     //pushed while one was already waiting, which stood in for it
+    uint32_t dropped;    //pushed while the queue was full
+} event_stats_t;
+
+BOOL eventPush(event_kind_t kind, uint16_t arg);
+BOOL eventPending();
+BOOL eventDispatch(); //at the start of each pass of every main state's state machine, see CSevents.c
+void eventStats(event_kind_t kind, event_stats_t* stats, BOOL reset);
+
+#endif	/* CSEVENTS_H */
+
@@ -0,0 +1,85 @@
+/*
+ * File:   CSidle.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Status monitoring spends most of its time waiting: in ALL_QUIET for the beacon to be due and in BEACON_ON for
+ * the transmission to end, with pending commands checked once a second in between. Instead of going around the
+ * main loop the whole time, it stops the processor until the next thing that can be due. Every deadline the
+ * main loop waits on ends in an interrupt:
+ * - telemetry, and with it the SD flush every 8 records and the sequence wait and exit conditions, comes from
+ *   the 1 Hz telemetry interrupt as events (see CSevents.c);
+ * - the beacon and all quiet timers, and any other software timer, come from the timer wheel's hardware
+ *   timer (see CStimerWheel.c), which is only set for the next tick that has something due;
+ * - radio commands come in through their own interrupts and are handed to the main loop as csEvents.
+ * So the earliest deadline is always the next of these interrupts, unless one has already happened. That is
+ * checked with interrupts held off, and the processor is stopped in the same section so an interrupt that
+ * comes in between can't be slept through: on this processor an interrupt wakes it even while its priority
+ * holds the interrupt off, and it is then taken as soon as the priority is given back.
+ *
+ * The processor only ever dozes (Idle), which leaves the peripheral clocks running. Sleep would stop them too:
+ * the telemetry and timer wheel timers run from the secondary oscillator and would keep going, but the beacon
+ * is keyed from a peripheral timer and the radio's serial peripheral needs its clock to take in a command
+ * while the satellite is quiet.
+ *
+ * The flight build dozes with the processor's PWRSAV instruction, which XC16 provides as Idle(). Any other build
+ * has to supply Metal_Idle to stand in for it: host/idleSim.c does, running status monitoring against a
+ * simulated clock and reporting the time spent dozing against the time awake.
+ *
+ * idleStats counts how often the processor dozed and how often something was already due.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CSidle.h"
+#include "CSevents.h"
+
+#if defined(__XC16__)
+#include <xc.h>
+#define idleDoze() Idle() //PWRSAV #1: the processor stops, the peripheral clocks keep running
+#else
+#define idleDoze() Metal_Idle()
+#endif
+
+static idle_stats_t idle;
+
+/*
+ * idleUntilDue
+ * INPUT: StatMonState state - status monitoring state that has nothing left to do
+ * OUTPUT: idle_mode_t - how far the processor was stopped
+ * INFO: Called by statusMonitoringStateMachine when the state it is in is only waiting. Stops the processor
+ *       until the next interrupt, unless one has already moved status monitoring on or left an event for the
+ *       main loop. A background job keeps an event waiting while it has steps left.
+ */
+idle_mode_t idleUntilDue(StatMonState state){
+    idle_mode_t mode;
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    if((Global->csState.statMonState != state) || eventPending() || (Global->csEvents != 0)){
+        mode = IDLE_AWAKE; //already due
+        idle.busy++;
+    }
+    else{
+        mode = IDLE_DOZE;
+        idle.dozes++;
+        idleDoze();
+    }
+    Metal_SetCPUPriority(priority);
+    return mode;
+}
+
+/*
+ * idleStats
+ * INPUT: idle_stats_t* stats - returns the counts so far
+ *        BOOL reset - true to start counting again
+ * OUTPUT: none
+ */
+void idleStats(idle_stats_t* stats, BOOL reset){
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    *stats = idle;
+    if(reset){
+        memset(&idle, 0, sizeof(idle));
+    }
+    Metal_SetCPUPriority(priority);
+}
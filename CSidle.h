@@ -0,0 +1,37 @@
+/*
+ * File:   CSidle.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Stops the processor while status monitoring waits, see CSidle.c
+ */
+
+#ifndef CSIDLE_H
+#define	CSIDLE_H
+
+#include <stdint.h>
+#include "types.h"
+#include "Globals.h"
+
+typedef enum{
+    IDLE_AWAKE = 0, //something was already due, the processor didn't stop
+    IDLE_DOZE,      //processor stopped, peripheral clocks kept running
+} idle_mode_t;
+
+typedef struct{
+    uint32_t dozes;       //times the processor dozed
+    uint32_t busy;        //times something was already due
+} idle_stats_t;
+
+idle_mode_t idleUntilDue(StatMonState state);
+void idleStats(idle_stats_t* stats, BOOL reset);
+
+//stop the processor until an interrupt, leaving the peripheral clocks running. The flight build uses Idle()
+//instead, any other build supplies this, see CSidle.c
+#if !defined(__XC16__)
+void Metal_Idle();
+#endif
+
+#endif	/* CSIDLE_H */
+
@@ -0,0 +1,210 @@
+/*
+ * File:   CSjobs.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Reformatting or checking the SD card can take seconds, far too long to run inside pendingProcess. These
+ * commands are handed to a background job instead, and their response poll item is left PENDING with a
+ * status of JOB_STATUS_RUNNING until the job finishes.
+ *
+ * Each sequence slot can have one job, and its sequence doesn't run another command until the job is done
+ * so commands still happen in the order they were uploaded. Jobs are small state machines advanced one step
+ * for each EVENT_JOB_STEP the status monitoring state machine handles, with interrupts enabled, so the
+ * telemetry interrupt keeps its 1 Hz cadence. The step events have the lowest priority, so telemetry and
+ * sequences go first. Only one job uses the card at a time, and while it does
+ * jobSDBusy is true: telemetry stays in its buffer and poll log appends are dropped (the poll log is
+ * compacted afterwards), so nothing else touches the card under it.
+ *
+ * A job can't be cancelled, even if its sequence is aborted, since stopping a format part way would leave the
+ * card unusable. Jobs are not kept in the globals, so after a reset jobsRestore reports any command the poll
+ * still shows as JOB_STATUS_RUNNING as JOB_STATUS_LOST, and the ground has to check the card and send it again.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "debug.h"
+#include "CSopenSourceFAT.h"
+#include "csSDCard.h"
+#include "CSresponsePoll.h"
+#include "CSpollLog.h"
+#include "CSpendingProcess.h"
+#include "CSjobs.h"
+#include "CSevents.h"
+
+#define JOB_NO_OWNER 0xFF //no job is using the card
+
+typedef enum{
+    JOB_STEP_START = 0, //waiting for the card
+    JOB_STEP_FORMAT,    //FSformat
+    JOB_STEP_MOUNT,     //Storage_Init on the new file system
+    JOB_STEP_RELOG,     //the format erased the poll log, write a new snapshot
+    JOB_STEP_CHECK,     //checkSDCard
+    JOB_STEP_DONE,      //report the status
+} job_step_t;
+
+static struct{
+    job_kind_t kind;
+    job_step_t step;
+    uint8_t    status;  //0, or JOB_STATUS_FAILED once a step fails
+    uint16_t   cmd_ID;  //response poll item of the command that submitted it
+} job[NUM_SEQUENCES];
+static uint8_t jobOwner = JOB_NO_OWNER; //slot whose job is using the card
+
+/*
+ * jobSubmit
+ * INPUT: uint8_t slot - csSequence slot of the command
+ *        job_kind_t kind - what to run
+ *        uint16_t cmd_ID - command ID the result is reported under
+ * OUTPUT: BOOL - false if the slot already has a job
+ * INFO: Called by decodeAndRunPending in place of running the command.
+ */
+BOOL jobSubmit(uint8_t slot, job_kind_t kind, uint16_t cmd_ID){
+    if(job[slot].kind != JOB_NONE){
+        return false;
+    }
+    job[slot].kind = kind;
+    job[slot].step = JOB_STEP_START;
+    job[slot].status = 0;
+    job[slot].cmd_ID = cmd_ID;
+    eventPush(EVENT_JOB_STEP, 0);
+    return true;
+}
+
+/*
+ * jobPending
+ * INPUT: uint8_t slot - csSequence slot
+ * OUTPUT: BOOL - true if the slot's job hasn't finished, so its sequence has to wait
+ */
+BOOL jobPending(uint8_t slot){
+    return (job[slot].kind != JOB_NONE);
+}
+
+/*
+ * jobSDBusy
+ * INPUT: none
+ * OUTPUT: BOOL - true while a job is using the SD card and nothing else may
+ */
+BOOL jobSDBusy(){
+    return (jobOwner != JOB_NO_OWNER);
+}
+
+/*
+ * jobStep
+ * INPUT: uint8_t slot - slot of the job using the card
+ * OUTPUT: none
+ * INFO: Advances the job by one step. A step that fails skips straight to reporting it.
+ */
+static void jobStep(uint8_t slot){
+    switch(job[slot].step){
+        case JOB_STEP_START:
+            job[slot].step = (job[slot].kind == JOB_REFORMAT_SD) ? JOB_STEP_FORMAT : JOB_STEP_CHECK;
+            break;
+        case JOB_STEP_FORMAT:
+            if(FSformat(1, 0, NULL) != 0){
+                dprintf("SD card reformat had an error: %d\n", FSerror());
+                job[slot].status = JOB_STATUS_FAILED;
+                job[slot].step = JOB_STEP_DONE;
+            }
+            else{
+                dprintf("SD card reformatted successfully\r\n");
+                job[slot].step = JOB_STEP_MOUNT;
+            }
+            break;
+        case JOB_STEP_MOUNT:
+            if(!Storage_Init()){
+                dprintf("Unable to init SD card. Error: %d\n", FSerror());
+                job[slot].status = JOB_STATUS_FAILED;
+                job[slot].step = JOB_STEP_DONE;
+            }
+            else{
+                job[slot].step = JOB_STEP_RELOG;
+            }
+            break;
+        case JOB_STEP_RELOG:
+            pollLogCompact();
+            job[slot].step = JOB_STEP_DONE;
+            break;
+        case JOB_STEP_CHECK:
+            checkSDCard();
+            dprintf("SD card check complete.\r\n");
+            job[slot].step = JOB_STEP_DONE;
+            break;
+        default:
+            job[slot].step = JOB_STEP_DONE;
+            break;
+    }
+}
+
+/*
+ * jobsRun
+ * INPUT: none
+ * OUTPUT: BOOL - true if a job took a step, so there may be more to do
+ * INFO: Called for each EVENT_JOB_STEP, see CSevents.c. If no job has the card the lowest slot with a job takes it, then
+ *       the job with the card takes one step. A finished job gives the card back before its command is
+ *       updated in the response poll to PENDING_COMPLETE with the job's status, so the update is logged.
+ */
+BOOL jobsRun(){
+    uint8_t slot;
+    resp_poll_t done;
+    cpu_priority_t priority;
+    if(jobOwner == JOB_NO_OWNER){
+        for(slot = 0; slot < NUM_SEQUENCES; slot++){
+            if(job[slot].kind != JOB_NONE){
+                jobOwner = slot;
+                break;
+            }
+        }
+        if(jobOwner == JOB_NO_OWNER){
+            return false;
+        }
+    }
+    slot = jobOwner;
+    jobStep(slot);
+    if(job[slot].step != JOB_STEP_DONE){
+        return true;
+    }
+    jobOwner = JOB_NO_OWNER;
+    job[slot].kind = JOB_NONE;
+    done.epoch = Global->csLastTelemetry.epoch;
+    done.cmd_ID = job[slot].cmd_ID;
+    done.type = PENDING_COMPLETE;
+    done.status = job[slot].status;
+    done.seqSlot = slot;
+    priority = pendingCritEnter();
+    respPollUpdatePending(done);
+    pendingCritExit(priority);
+    return true;
+}
+
+/*
+ * jobsRestore
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called once the response poll has been restored after a reset. No job survives a reset, so every PENDING
+ *       item still showing JOB_STATUS_RUNNING is updated to PENDING_COMPLETE with JOB_STATUS_LOST. Updating
+ *       an item moves it to the newest end of the poll, so the search starts over after each one.
+ */
+void jobsRestore(){
+    resp_poll_t lost;
+    uint8_t i;
+    BOOL found = true;
+    while(found){
+        found = false;
+        for(i = 0; i < Global->csResponsePoll.used; i++){
+            resp_poll_t const* item =
+                &Global->csResponsePoll.poll_queue[(Global->csResponsePoll.tail + i) % RESP_POLL_SIZE];
+            if((item->type == PENDING) && (item->status == JOB_STATUS_RUNNING)){
+                lost = *item;
+                found = true;
+                break;
+            }
+        }
+        if(found){
+            lost.epoch = Global->csLastTelemetry.epoch;
+            lost.type = PENDING_COMPLETE;
+            lost.status = JOB_STATUS_LOST;
+            respPollUpdatePending(lost);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * File:   CSjobs.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Background jobs for pending commands that take too long to run inside pendingProcess, see CSjobs.c
+ */
+
+#ifndef CSJOBS_H
+#define	CSJOBS_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CSpendingProcess.h"
+
+//response poll statuses of a command handed to a job
+#define JOB_STATUS_RUNNING 43 //submitted and not finished yet, the item stays PENDING
+#define JOB_STATUS_FAILED  44 //finished with an error, reported as PENDING_COMPLETE
+#define JOB_STATUS_LOST    47 //was still running at a reset, check the card and send the command again
+
+typedef enum{
+    JOB_NONE = 0,
+    JOB_REFORMAT_SD,  //FSformat then Storage_Init
+    JOB_CHECK_SD,     //checkSDCard
+} job_kind_t;
+
+BOOL jobSubmit(uint8_t slot, job_kind_t kind, uint16_t cmd_ID);
+BOOL jobPending(uint8_t slot);
+BOOL jobSDBusy();
+BOOL jobsRun();
+void jobsRestore();
+
+#endif	/* CSJOBS_H */
+
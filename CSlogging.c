@@ -14,6 +14,7 @@
 /* System & Local Includes */
 #include <string.h>
 #include "metal/timers.h"
+#include "metal/cpu.h"
 #include "CSlogging.h"
 #include "CSdefine.h"
 #include "CStemp.h"
@@ -25,6 +26,11 @@
 #include "debug.h"
 #include "CSopenSourceFAT.h"
 #include "CSstateStatusMonitoring.h"
+#include "CSbeacon.h"
+#include "CScondWatch.h"
+#include "CSderived.h"
+#include "CSjobs.h"
+#include "CSevents.h"
 #include "Globals.h"
 
 //#include "CStimeElapse.h" // fortesting remove before flight
@@ -40,17 +46,20 @@
  *       The ADCs are called in order and stored in order so that this function can process faster.
  *       This set of telemetry is then added to the buffer that colects telem to be flushed to the SD card.
  *
- *       Afterwards, every 8th call of this function initiates the flush to SD function.
+ *       Afterwards, every 8th call of this function asks the main loop to flush to SD (EVENT_FLUSH_DUE).
  *
- *       The basic telemetry and last telemetry are updated.
+ *       The basic telemetry and last telemetry are updated, and the beacon string is brought up to date
+ *       with the new values so it is ready whenever the beacon is turned on. The derived signals pending command
+ *       conditions refer to are updated, and conditions that depend on a reading that changed enough to matter
+ *       are marked to be evaluated again.
  *
  *       SettleGlobal is also called. this is done since we only want this to happen once per second
  *       It was previously happening WAY more often (unnecessary due to the probability of bit errors)
  *       and a second timer that occurs once per second could interfere with this timer.
  *
- *       Because we now have new data, the state status monitoring state machine is ready to be put into
- *       the pending processing state. This way the state status monitoring state machine will only check
- *       and execute the pending command sequence once per second and can continue in any of the other states.
+ *       Because we now have new data, EVENT_TELEMETRY is pushed for the state status monitoring state machine
+ *       (see CSevents.c). This way it will only check and execute the pending command sequences once per second
+ *       and can continue in any of its states.
  */
 void handleTelemetryRecording(){
     dprintf("TlmLog\r\n");
@@ -132,19 +141,20 @@ void handleTelemetryRecording(){
         G_SET(csTelemetry.buf, &buf);
 
         if(linearBuf_count(&Global->csTelemetry.buf) >= 8){
-            startFlushToSD();
+            eventPush(EVENT_FLUSH_DUE, 0); //written out by the main loop, not in the interrupt
         }
 
 
         //add to basic telemetry averages
         storeBasicTelemetry(tlmBuff);
         SettleGlobal();
-        G_SET(csLastTelemetry, values.readings); //record the most recent telem values - for use by
+        G_SET(csLastTelemetry.reading, values.readings); //record the most recent telem values - for use by
+        G_SET(csLastTelemetry.epoch, &tlmBuff.epoch); //pending processing uses this instead of reading the RTC again
+        beaconMsgUpdateTelemetry(); //keep the beacon current with the new values
+        derivedUpdate(Global->csLastTelemetry.reading); //means and deltas that conditions refer to
+        condWatchTelemetry(Global->csLastTelemetry.reading); //wake any conditions waiting on these readings
 
-        if(Global->csState.statMonState != PENDING_PROCESS){
-            StatMonState newState = PENDING_PROCESS;
-            changeStatMonState(newState); //update so next time we go through state status monitoring we will check pending commands
-        }
+        eventPush(EVENT_TELEMETRY, 0); //so the next pass through state status monitoring checks pending commands
 }
 
 void epoch_to_telemetry_filename(uint32_t epoch, char filename[12]) {
@@ -167,11 +177,11 @@ void epoch_to_telemetry_filename(uint32_t epoch, char filename[12]) {
 /*
  *
  * Function:
- *      startFlushToSD()
+ *      flushTelemetryToSD()
  * Summary:
  *      Flushes telemetry buffer to daily .TEL file on SD card
  * Conditions:
- *      Called from OnMetal_FlushTelem_Tick() located in CSmain.c
+ *      Called from the main loop when EVENT_FLUSH_DUE or EVENT_FLUSH_TICK is handled (see CSevents.c)
  * Input:
  *      None
  * Return Values:
@@ -179,25 +189,35 @@ void epoch_to_telemetry_filename(uint32_t epoch, char filename[12]) {
  * Side Effects:
  *      Daily .TEL file is updated on the SD card
  * Description:
- *      Function opens the daily .TEL file on the SD card and flushs the
- *      telemetry buffer to it. Then, the buffer is cleared.
+ *      Function takes a copy of the telemetry buffer and clears it with
+ *      interrupts held off, then opens the daily .TEL file on the SD card
+ *      and flushs the copy to it with interrupts enabled.
+ *      Nothing is written while a background job is using the card, the
+ *      telemetry stays in the buffer until the next flush after it is done.
  * Remarks:
  *      Written by Natalia Alonso
  *
  *
  */
-void startFlushToSD(){
-    uint16_t old_tail = Global->csTelemetry.buf.tail;
-    G_SET(csTelemetry.buf.tail,NULL);
-
+void flushTelemetryToSD(){
+    if(jobSDBusy()){
+        return;
+    }
     FSFILE* testFile = NULL;
     uint32_t epoch = 0ul;
 
     char filename[] = "00000000.TEL";
     LinearBuf bufTemp;
+    uint16_t count;
+    //take the readings and empty the buffer together, so one the telemetry interrupt adds meanwhile isn't lost
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
     memcpy(&bufTemp, &Global->csTelemetry.buf, sizeof(bufTemp));
+    G_SET(csTelemetry.buf, NULL); //empty the buffer
+    Metal_SetCPUPriority(priority);
+    bufTemp.tail = 0;
+    count = linearBuf_count(&bufTemp);
 
-    for (uint16_t i = 0; i < linearBuf_count(&Global->csTelemetry.buf); ++i) {
+    for (uint16_t i = 0; i < count; ++i) {
         telemetry_block_t block;
         linearBuf_get(&bufTemp, &block);
 
@@ -218,10 +238,19 @@ void startFlushToSD(){
         FSfclose(testFile);
     }
 
-    dprintf("FLUSH!! Wrote %u items\r\n", linearBuf_count(&Global->csTelemetry.buf));
+    dprintf("FLUSH!! Wrote %u items\r\n", count);
+}
+
 
-    G_SET(csTelemetry.buf.tail, &old_tail);
-    G_SET(csTelemetry.buf, NULL); //empty the buffer
+/*
+ * startFlushToSD
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called from OnMetal_FlushTelem_Tick() in CSmain.c, inside its timer interrupt, so the FAT code can't be
+ *       entered while the main loop is in it. Only asks the main loop to flush (EVENT_FLUSH_TICK).
+ */
+void startFlushToSD(){
+    eventPush(EVENT_FLUSH_TICK, 0);
 }
 
 
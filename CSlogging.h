@@ -44,10 +44,15 @@ void handleTelemetryRecording();
 void epoch_to_telemetry_filename(uint32_t epoch, char filename[12]);
 
 /**
- * Start flushing telemetry to SD card
+ * Start flushing telemetry to SD card, from the flush timer interrupt
  */
 void startFlushToSD();
 
+/**
+ * Flush telemetry to SD card, from the main loop
+ */
+void flushTelemetryToSD();
+
 
 //writing to the monitoring file
 void writeToMonitor(INT64 time);
@@ -0,0 +1,246 @@
+/*
+ * File:   CSopcodes.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Every command the satellite can run is registered once in OPCODE_TABLE with its handler and the paths it may
+ * be run from. Pending commands from a sequence are run through
+ * opcodeDispatch by decodeAndRunPending. Immediate commands are meant to go through it as well with
+ * OPCODE_IMMEDIATE, in place of their own entries in the command parser's command_list[], so an opcode can't
+ * behave differently depending on where it came from.
+ *
+ * The number of calls of each opcode, and how many of them failed, are kept and sent to the ground with
+ * opcodeStatsResponse. Handlers aren't timed: the processor has no free running cycle counter to time them with.
+ * The statistics are not kept in the globals, they only describe what has happened since the last reset or
+ * opcodeStatsClear.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "debug.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+#include "CSjournal.h"
+#include "csRadio.h"
+#include "CSswitchCommands.h"
+#include "CSbeacon.h"
+#include "CSjobs.h"
+#include "CSopcodes.h"
+
+/*
+ * opStartSequence
+ * INPUT: uint8_t slot - csSequence slot the command came from
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ */
+static uint8_t opStartSequence(uint8_t slot, seq_command_t const* cmd){
+    dprintf("Start sequence\r\n");
+    return 0;
+}
+
+/*
+ * opLoadRadioConfig
+ * INPUT: uint8_t slot - csSequence slot the command came from
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ * INFO: The configuration is the one uploaded with the sequence.
+ */
+static uint8_t opLoadRadioConfig(uint8_t slot, seq_command_t const* cmd){
+    journal_t journalTemp;
+    //store away a copy of the journal structure
+    Journal_GetStruct(&journalTemp);
+    journalTemp.radioConfigs = Global->csSequence[slot].configs;
+    Journal_SetStruct(&journalTemp);
+
+    //Send a pointer to the radio configuration structure to Radio Code.
+    radioConfig(&Global->csSequence[slot].configs);
+    dprintf("Radio Configuration\r\n");
+    return 0;
+}
+
+/*
+ * opReloadRadioConfig
+ * INPUT: uint8_t slot - csSequence slot the command came from, or OPCODE_NO_SLOT
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ */
+static uint8_t opReloadRadioConfig(uint8_t slot, seq_command_t const* cmd){
+    journal_t journalTemp;
+    //load the configuration last stored in the journal
+    dprintf("Reload Radio Configuration\r\n");
+    Journal_GetStruct(&journalTemp);
+    radioConfig(&journalTemp.radioConfigs);
+    return 0;
+}
+
+/*
+ * opSetSwitch
+ * INPUT: uint8_t slot - csSequence slot the command came from, or OPCODE_NO_SLOT
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ */
+static uint8_t opSetSwitch(uint8_t slot, seq_command_t const* cmd){
+    setPCASwitch(cmd->params.set_switch.pca_id, cmd->params.set_switch.config);
+    dprintf("PCA %u configured as %u\r\n", cmd->params.set_switch.pca_id, cmd->params.set_switch.config);
+    return 0;
+}
+
+/*
+ * opProcessorMode
+ * INPUT: uint8_t slot - csSequence slot the command came from, or OPCODE_NO_SLOT
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ */
+static uint8_t opProcessorMode(uint8_t slot, seq_command_t const* cmd){
+    setProcMode(cmd->params.set_proc_mode.mode);
+    dprintf("Processor mode has been set.\r\n");
+    return 0;
+}
+
+/*
+ * opCheckSD
+ * INPUT: uint8_t slot - csSequence slot the command came from
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ * INFO: Checking the card takes too long to do here, it is handed to a background job (see CSjobs.c).
+ *       If the slot already has a job the command is reported as OPCODE_STATUS_JOB_BUSY instead.
+ */
+static uint8_t opCheckSD(uint8_t slot, seq_command_t const* cmd){
+    if(!jobSubmit(slot, JOB_CHECK_SD, cmd->cmd_id)){
+        dprintf("Slot %u already has a job\r\n", slot);
+        return OPCODE_STATUS_JOB_BUSY;
+    }
+    return JOB_STATUS_RUNNING;
+}
+
+/*
+ * opReformatSD
+ * INPUT: uint8_t slot - csSequence slot the command came from
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ * INFO: Handed to a background job like opCheckSD.
+ */
+static uint8_t opReformatSD(uint8_t slot, seq_command_t const* cmd){
+    if(!jobSubmit(slot, JOB_REFORMAT_SD, cmd->cmd_id)){
+        dprintf("Slot %u already has a job\r\n", slot);
+        return OPCODE_STATUS_JOB_BUSY;
+    }
+    return JOB_STATUS_RUNNING;
+}
+
+/*
+ * opEndSequence
+ * INPUT: uint8_t slot - csSequence slot the command came from
+ *        seq_command_t const* cmd - the command
+ * OUTPUT: uint8_t - response poll status
+ */
+static uint8_t opEndSequence(uint8_t slot, seq_command_t const* cmd){
+    dprintf("End Sequence\r\n");
+    beaconMsgUpdateSingle(SOFTWARE_STATE,'C');
+    return 0;
+}
+
+/*
+ * Commands that use their sequence's slot, or hand work to a job the sequence waits on, can only be run
+ * pending.
+ */
+static const opcode_entry_t OPCODE_TABLE[] = {
+    {OP_START_SEQUENCE,             opStartSequence,     OPCODE_PENDING},
+    {OP_LOAD_RADIO_CONFIGURATION,   opLoadRadioConfig,   OPCODE_PENDING},
+    {OP_RELOAD_RADIO_CONFIGURATION, opReloadRadioConfig, OPCODE_IMMEDIATE | OPCODE_PENDING},
+    {OP_SET_SWITCH,                 opSetSwitch,         OPCODE_IMMEDIATE | OPCODE_PENDING},
+    {OP_PROCESSOR_MODE,             opProcessorMode,     OPCODE_IMMEDIATE | OPCODE_PENDING},
+    {OP_CHECK_SD_CARD,              opCheckSD,           OPCODE_PENDING},
+    {OP_REFORMAT_SD,                opReformatSD,        OPCODE_PENDING},
+    {OP_END_SEQUENCE,               opEndSequence,       OPCODE_PENDING},
+};
+#define OPCODE_TABLE_SIZE (sizeof(OPCODE_TABLE) / sizeof(OPCODE_TABLE[0]))
+
+typedef struct{
+    uint16_t count;     //calls, stops at 0xFFFF
+    uint16_t failures;  //calls that returned an error status, stops at 0xFFFF
+} opcode_stats_t;
+
+static opcode_stats_t opcodeStats[OPCODE_TABLE_SIZE]; //same order as OPCODE_TABLE
+
+/*
+ * opcodeStatsRecord
+ * INPUT: uint8_t i - index of the opcode in OPCODE_TABLE
+ *        uint8_t status - response poll status its handler returned
+ * OUTPUT: none
+ * INFO: A handed off job hasn't failed yet, so only statuses other than 0 and JOB_STATUS_RUNNING count as failures.
+ */
+static void opcodeStatsRecord(uint8_t i, uint8_t status){
+    opcode_stats_t* s = &opcodeStats[i];
+    if(s->count < 0xFFFF){
+        s->count++;
+    }
+    if((status != 0) && (status != JOB_STATUS_RUNNING) && (s->failures < 0xFFFF)){
+        s->failures++;
+    }
+}
+
+/*
+ * opcodeDispatch
+ * INPUT: uint8_t mode - OPCODE_IMMEDIATE or OPCODE_PENDING, the path the command came from
+ *        uint8_t slot - csSequence slot of a pending command, OPCODE_NO_SLOT for an immediate one
+ *        seq_command_t const* cmd - the command to run
+ * OUTPUT: uint8_t - response poll status of the command, from its handler or OPCODE_STATUS_NOT_ALLOWED or
+ *         OPCODE_STATUS_UNKNOWN if it wasn't run
+ * INFO: Finds the opcode in OPCODE_TABLE, checks it may be run from this path, then runs its handler.
+ */
+uint8_t opcodeDispatch(uint8_t mode, uint8_t slot, seq_command_t const* cmd){
+    uint8_t i;
+    uint8_t status;
+    for(i = 0; i < OPCODE_TABLE_SIZE; i++){
+        if(OPCODE_TABLE[i].opcode == cmd->opcode){
+            break;
+        }
+    }
+    if(i == OPCODE_TABLE_SIZE){
+        dprintf("UNKNOWN COMMAND %u\r\n", cmd->opcode);
+        return OPCODE_STATUS_UNKNOWN;
+    }
+    if(!(OPCODE_TABLE[i].modes & mode)){
+        dprintf("Command %u not allowed from here\r\n", cmd->opcode);
+        return OPCODE_STATUS_NOT_ALLOWED;
+    }
+    status = OPCODE_TABLE[i].handler(slot, cmd);
+    opcodeStatsRecord(i, status);
+    return status;
+}
+
+/*
+ * opcodeStatsResponse
+ * INPUT: char* telem - character array utilized to send data to the ground, OPCODE_TABLE_SIZE * OPCODE_STATS_BYTES long
+ * RETURN: uint16_t - tells the number of characters utilized
+ * INFO: For each opcode that has been run, MSB first: the opcode, number of calls, then the calls that failed.
+ */
+uint16_t opcodeStatsResponse(char* telem){
+    uint8_t i;
+    uint16_t n = 0;
+    for(i = 0; i < OPCODE_TABLE_SIZE; i++){
+        opcode_stats_t const* s = &opcodeStats[i];
+        if(s->count == 0){
+            continue;
+        }
+        telem[n+0] = OPCODE_TABLE[i].opcode;
+        telem[n+1] = s->count >> 8;
+        telem[n+2] = s->count;
+        telem[n+3] = s->failures >> 8;
+        telem[n+4] = s->failures;
+        n += OPCODE_STATS_BYTES;
+    }
+    return n;
+}
+
+/*
+ * opcodeStatsClear
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Starts the statistics over, for instance once the ground has downlinked them.
+ */
+void opcodeStatsClear(){
+    memset(opcodeStats, 0, sizeof(opcodeStats));
+}
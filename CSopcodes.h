@@ -0,0 +1,43 @@
+/*
+ * File:   CSopcodes.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Registration table of every command opcode and its handler, with call counts, see CSopcodes.c
+ */
+
+#ifndef CSOPCODES_H
+#define	CSOPCODES_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CSpendingCommand.h"
+
+//paths a command may be run from, opcode_entry_t modes is a combination of these
+#define OPCODE_IMMEDIATE 0x01 //run by the command parser as soon as it is received
+#define OPCODE_PENDING   0x02 //run by pendingProcess from a sequence
+
+#define OPCODE_NO_SLOT   0xFF //slot given for immediate commands, which don't belong to a sequence
+
+//response poll statuses of commands that weren't run
+#define OPCODE_STATUS_NOT_ALLOWED 45 //the opcode can't be run from this path
+#define OPCODE_STATUS_UNKNOWN     46 //no such opcode
+#define OPCODE_STATUS_JOB_BUSY    48 //the slot already has a job, so the command's job wasn't submitted
+
+#define OPCODE_STATS_BYTES 5 //opcode, calls, calls that failed, see opcodeStatsResponse
+
+typedef uint8_t (*opcode_handler_t)(uint8_t slot, seq_command_t const* cmd);
+
+typedef struct{
+    opcode_t         opcode;
+    opcode_handler_t handler; //returns the response poll status of the command
+    uint8_t          modes;   //OPCODE_IMMEDIATE and/or OPCODE_PENDING
+} opcode_entry_t;
+
+uint8_t opcodeDispatch(uint8_t mode, uint8_t slot, seq_command_t const* cmd);
+uint16_t opcodeStatsResponse(char* telem);
+void opcodeStatsClear();
+
+#endif	/* CSOPCODES_H */
+
@@ -11,22 +11,60 @@
 #include "CSstateStatusMonitoring.h"
 #include "Globals.h"
 #include "CSbeacon.h"
+#include "CSpollLog.h"
+#include "CScondition.h"
+#include "CScondWatch.h"
+#include "CSderived.h"
+#include "CSjobs.h"
+#include "CSopcodes.h"
 #include "metal/cpu.h"
 #include "csSDCard.h"
 #include "csRadio.h"
 #include "CSjournal.h"
 #include "CSswitchCommands.h"
 
+static uint8_t seqNextSlot; //slot the scheduler starts from on the next pendingProcess call
+static uint8_t seqGen[NUM_SEQUENCES]; //bumped whenever a sequence is changed, so an evaluation can tell it's stale
+
+/**
+ * abortSequenceClear
+ * @param slot - csSequence slot of the sequence being aborted
+ * INFO: clears out the pending command sequence. Called with interrupts held off, see pendingCritEnter.
+ */
+static void abortSequenceClear(uint8_t slot){
+    G_SET(csSequence[slot].cmd_queue, NULL);
+    seqGen[slot]++;
+    derivedRefsChanged();
+}
+
+/**
+ * abortSequencePoll
+ * @param slot - csSequence slot of the sequence being aborted
+ * @param status - status value that was determined from which exit condition triggered the abort
+ * @param time - time that the abort occurrs
+ * INFO: updates all of the pending commands of the cleared sequence not executed in the response poll
+ *       to show that they were aborted, and logs the abort. Runs with interrupts enabled.
+ */
+static void abortSequencePoll(uint8_t slot, uint8_t status, uint32_t time){
+    poll_log_abort_t rec;
+    respPollAbort(slot, status, time);
+    rec.time = time;
+    rec.status = status;
+    rec.slot = slot;
+    pollLogAppend(POLL_LOG_ABORT, &rec, sizeof(rec));
+}
+
 /**
  * abortSequence
+ * @param slot - csSequence slot of the sequence being aborted
  * @param status - status value that was determined from which exit condition triggered the abort
  * @param time - time that the abort occurrs
  * INFO: clear out the pending command sequence and update all of the pending commands not executed
- *       in the response poll to show that they were aborted
+ *       in the response poll to show that they were aborted. Other sequences are not affected.
  */
-void abortSequence(uint8_t status, uint32_t time){
-    G_SET(csSequence.cmd_queue, NULL);
-    respPollAbort(status, time);
+void abortSequence(uint8_t slot, uint8_t status, uint32_t time){
+    abortSequenceClear(slot);
+    abortSequencePoll(slot, status, time);
 }
 
 
@@ -34,28 +72,42 @@ void abortSequence(uint8_t status, uint32_t time){
  * checkCond
  * @param evaluating - the condition_t to be evaluated, which contains the index of the sensor
  *                     to be evaluated, the operator type, and the count value to be compared against
+ * @param now - csunSatEpoch time the conditions are being checked at
+ * @param relBase - lastCmdTime of the sequence the condition belongs to
  * @return TRUE representing if the condition_t checked was true or not.
  * INFO: This function takes in a condition_t, which is used by both pending commands for their wait conditions
  *       and as the exit conditions.
  *       The sensor ID is used to get the corresponding value from the last telemetry values.
  *       There are TWO special IDs that are not onboard sensor IDs to identify relative and absolute time conditions.
  *       Absolute time uses the current time (encoded in csunSatEpoch) and relative time subtracts the time the last
- *       command was executed from the current time.
+ *       command was executed from the current time. The current time is passed in so the RTC isn't read over I2C
+ *       for every time condition.
  *       The "current" value is compared to the condition value and the boolean result of the comparison is returned.
+ *       A third special ID, PSENSOR_CONDITION_PROGRAM, runs the condition program at the offset in the value instead
+ *       (see CScondition.c), and IDs from PSENSOR_DERIVED_FIRST to PSENSOR_BATT_DELTA compare a derived signal such as
+ *       a rolling mean instead of a single reading (see CSderived.c).
 
  */
-BOOL checkCond(condition_t evaluating){
+BOOL checkCond(condition_t evaluating, uint32_t now, uint32_t relBase){
     //need to know sensor number being used for TIME value
     uint32_t sensor_val;
     BOOL ret = false;
     //get the most recent sensor value
-    if(evaluating.sensor_id == PSENSOR_COMMAND_RELATIVE_TIME){
+    if(evaluating.sensor_id == PSENSOR_CONDITION_PROGRAM){
+        uint8_t status;
+        return condProgramEval(evaluating.value, now, &status);
+    }
+    else if(evaluating.sensor_id == PSENSOR_COMMAND_RELATIVE_TIME){
         dprintf("relative time check - ");
-        sensor_val = (csunSatEpoch(getRTC()) - Global->csSequence.lastCmdTime); //should always be a positive value...
+        sensor_val = (now - relBase); //should always be a positive value...
     }
     else if (evaluating.sensor_id == PSENSOR_ABSOLUTE_TIME){
         dprintf("time check - ");
-        sensor_val = csunSatEpoch(getRTC());
+        sensor_val = now;
+    }
+    else if(PSENSOR_IS_DERIVED(evaluating.sensor_id)){
+        dprintf("derived %d val - ",evaluating.sensor_id);
+        sensor_val = derivedReading(evaluating.sensor_id);
     }
     else{
         dprintf("sensor %d val - ",evaluating.sensor_id);
@@ -103,87 +155,281 @@ BOOL checkCond(condition_t evaluating){
 }
 
 /**
- * decodeAndRunPending
- * @param cmd - command that will be executed
- * RETURN: none
- * INFO: Once a command is to be processed it is passed into this function and it is executed.
- *       A switch statement is used in a similar function to the old version of the command parser
- *       to call the command specified by the opcode.
+ * checkLeaf
+ * @param cond - one condition of an exit or wait condition
+ * @param now - csunSatEpoch time the conditions are being checked at
+ * @param relBase - lastCmdTime of the sequence the condition belongs to
+ * @param status - returns the program's status if the condition is a condition program, otherwise 0
+ * @return TRUE if the condition is met
  */
-void decodeAndRunPending(seq_command_t cmd){
-    int16_t reformatResult;
-    BYTE reformatMode = 1;
-    journal_t journalTemp;
-    
-    switch(cmd.opcode){
-        case OP_START_SEQUENCE: //start sequence
-            dprintf("Start sequence\r\n");
-            break;
-        case OP_LOAD_RADIO_CONFIGURATION: //load radio config
-            //store away a copy of the journal structure
-            Journal_GetStruct(&journalTemp);
-            journalTemp.radioConfigs = Global->csSequence.configs;
-            Journal_SetStruct(&journalTemp);
+static BOOL checkLeaf(condition_t const* cond, uint32_t now, uint32_t relBase, uint8_t* status){
+    if(cond->sensor_id == PSENSOR_CONDITION_PROGRAM){
+        return condProgramEval(cond->value, now, status);
+    }
+    *status = 0;
+    return checkCond(*cond, now, relBase);
+}
 
-            //Send a pointer to the radio configuration structure to Radio Code.
-            radioConfig(&Global->csSequence.configs);
-            dprintf("Radio Configuration\r\n");
-            break;
-        case OP_RELOAD_RADIO_CONFIGURATION: //reload default radio configs
-            //Send null to radio, indicating to load defualt values
-            dprintf("Reload Radio Configuration\r\n");
-            Journal_GetStruct(&journalTemp);
-            radioConfig(&journalTemp.radioConfigs);
-            break;
-        case OP_SET_SWITCH://set swith
-            setPCASwitch(cmd.params.set_switch.pca_id,cmd.params.set_switch.config);
-            dprintf("PCA %u configured as %u\r\n",cmd.params.set_switch.pca_id,cmd.params.set_switch.config);
-            //cmd.params.set_switch.id;
-            break;
-        case OP_PROCESSOR_MODE: //processor mode
-            setProcMode(cmd.params.set_proc_mode.mode);
-            dprintf("Processor mode has been set.\r\n");
+/**
+ * checkConditions
+ * @param cond - exit or wait conditions to be evaluated
+ * @param now - csunSatEpoch time the conditions are being checked at
+ * @param relBase - lastCmdTime of the sequence the conditions belong to
+ * @param status - returns which condition decided the result
+ * @return TRUE if the conditions are met
+ * INFO: Evaluates the one or two conditions by JUST, AND or OR, only checking the right condition if the left one
+ *       didn't already decide the result. The status codes are the ones the response poll has always reported:
+ *       1 for JUST, 2 for AND, 5 for an OR met by its left condition and 4 for one met only by its right.
+ *       If the condition that decided the result is a condition program, the program's status is reported instead,
+ *       naming the leaf that decided it (COND_STATUS_LEAF + its tag).
+ */
+static BOOL checkConditions(conditions_t const* cond, uint32_t now, uint32_t relBase, uint8_t* status){
+    uint8_t leafStatus = 0;
+    BOOL result = checkLeaf(&cond->left, now, relBase, &leafStatus);
+    switch(cond->op){
+        case JUST:
+            *status = 1;
             break;
-        case OP_CHECK_SD_CARD: //check SD
-            checkSDCard();
-            dprintf("SD card check complete.\r\n");
+        case AND:
+            if(result){
+                result = checkLeaf(&cond->right, now, relBase, &leafStatus);
+            }
+            *status = 2;
             break;
-        case OP_REFORMAT_SD: //reformat SD
-            reformatResult = FSformat(reformatMode,0,NULL);
-            if(!reformatResult){
-                dprintf("SD card reformatted successfully\r\n");
-                if (!Storage_Init()) {
-                    dprintf("Unable to init SD card. Error: %d\n", FSerror());
-                }
+        case OR:
+            if(!result){
+                result = checkLeaf(&cond->right, now, relBase, &leafStatus);
+                *status = 4;
             }
             else{
-                dprintf("SD card reformat had an error: %d\n", FSerror());
+                *status = 5;
             }
             break;
-        case OP_END_SEQUENCE://end sequence
-            dprintf("End Sequence\r\n");
-            beaconMsgUpdateSingle(SOFTWARE_STATE,'C');
-            break;
-        default: //uh oh
-            dprintf("UNKNOWN PENDING COMMAND IN SEQUENCE\r\n");
-            break;
+        //no default since these three cases are all possible values
+    }
+    if(leafStatus != 0){
+        *status = leafStatus;
+    }
+    return result;
+}
+
+/**
+ * condUsesRelativeTime
+ * @param cond - a wait condition
+ * @return TRUE if the condition depends on the time since the last command
+ * INFO: Condition programs never do, condProgramLoad doesn't allow relative times in them.
+ */
+static BOOL condUsesRelativeTime(condition_t cond){
+    return (cond.sensor_id == PSENSOR_COMMAND_RELATIVE_TIME);
+}
+
+/**
+ * decodeAndRunPending
+ * @param slot - csSequence slot the command came from
+ * @param cmd - command that will be executed
+ * RETURN: uint8_t - response poll status of the command, 0 if it was run, JOB_STATUS_RUNNING if it was
+ *         handed to a background job or OPCODE_STATUS_NOT_ALLOWED/OPCODE_STATUS_UNKNOWN if it couldn't be run
+ * INFO: Once a command is to be processed it is passed into this function and it is executed.
+ *       The handler for its opcode is looked up in the opcode table and timed (see CSopcodes.c).
+ *       Commands that use the SD card for seconds at a time are submitted as background jobs (see CSjobs.c).
+ */
+uint8_t decodeAndRunPending(uint8_t slot, seq_command_t cmd){
+    return opcodeDispatch(OPCODE_PENDING, slot, &cmd);
+}
 
+
+/**
+ * sequenceUploadSlot
+ * @param slot - csSequence slot the ground wants to load its next sequence into
+ * @return 0 if the slot was selected, 0xFF if there is no such slot, 0xFE if a sequence is still running in it
+ * INFO: Sequence commands from the ground are loaded into csSequence[csSequenceUpload] and tagged with it in the
+ *       response poll. A running sequence has to finish or be aborted before its slot can be loaded again.
+ */
+uint8_t sequenceUploadSlot(uint8_t slot){
+    if(slot >= NUM_SEQUENCES){
+        return 0xFF;
+    }
+    if(PendCmdQueue_Count(&Global->csSequence[slot].cmd_queue) > 0){
+        return 0xFE;
     }
+    G_SET(csSequenceUpload, &slot);
+    return 0;
 }
 
+/**
+ * pendingCritEnter
+ * @return the priority to give back to pendingCritExit
+ * INFO: Starts a critical section for changing the sequences or the response poll from outside an interrupt.
+ */
+cpu_priority_t pendingCritEnter(){
+    return Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+}
+
+/**
+ * pendingCritExit
+ * @param priority - returned by pendingCritEnter
+ * INFO: Ends the critical section.
+ */
+void pendingCritExit(cpu_priority_t priority){
+    Metal_SetCPUPriority(priority);
+}
+
+/**
+ * pendingProcessSlot
+ * @param slot - csSequence slot to process
+ * @param time - csunSatEpoch time of the telemetry just recorded
+ * @param mayRun - FALSE if this call's command budget is used up, so only the exit conditions are checked
+ * @return TRUE if a command from the sequence was run
+ * INFO: One pendingProcess step for one sequence, see pendingProcess.
+ *       Everything is worked out from a snapshot of the slot with interrupts enabled. The changes are only
+ *       made in a short critical section, and only if the slot's generation shows nothing changed it since.
+ */
+static BOOL pendingProcessSlot(uint8_t slot, uint32_t time, BOOL mayRun){
+    if( (Global->csSequence[slot].cmd_queue.count == 0) || (Global->csSequence[slot].seq_ready_flag == 0) /*&& (Link_GetMode() & ~(LINK_SEQUENCING | LINK_ACTIVE))*/){
+        return false;
+    }
+    uint8_t gen = seqGen[slot];
+    cpu_priority_t priority;
+    BOOL current;
+    //check the exit conditions and fix them if either is a relative time
+    dprintf("sequence %u time = %ld\r\n", slot, time);
+    conditions_t exitCheck = Global->csSequence[slot].exit;
+    BOOL exitFixed = false;
+    if(exitCheck.left.sensor_id == 254){ //change this to an absolute time value
+        dprintf("delta time  of %ld being changed -",exitCheck.left.value);
+        exitCheck.left.value += time;
+        dprintf("now absolute of %ld\r\n",exitCheck.left.value);
+        exitCheck.left.sensor_id = 255;
+        exitFixed = true;
+    }
+    if(exitCheck.op != JUST){//AND or OR is the operator, meaning right comparator is present
+        if(exitCheck.right.sensor_id == 254){ //change this to an absolute time value
+            exitCheck.right.value += time;
+            exitCheck.right.sensor_id = 255;
+            exitFixed = true;
+        }
+    }
+
+    dprintf("Checking pending Command sequence\r\n");
+    //going to place EXIT/WAIT checks for pending commands here.
+    resp_poll_t updating;
+    uint32_t relBase = Global->csSequence[slot].lastCmdTime;
+
+    seq_command_t pendingCmd;
+    PendCmdQueue queueTemp;
+    memcpy(&queueTemp, &Global->csSequence[slot].cmd_queue, sizeof(queueTemp)); //read
+    PendCmdQueue_Peek(&queueTemp, &pendingCmd);
+
+    BOOL result = false;
+    //first check to see if we need to EXIT
+    dprintf("Exit condition check - ");
+    if(!condWatchCached(COND_WATCH_EXIT(slot), &exitCheck, relBase, time, &result, &updating.status)){
+        uint16_t stamp = condWatchStamp();
+        result = checkConditions(&exitCheck, time, relBase, &updating.status);
+        condWatchArm(COND_WATCH_EXIT(slot), &exitCheck, relBase, time, stamp, result, updating.status);
+    }
+
+    if(result){
+        dprintf("ABORTING SEQUENCE!\r\n");
+        //if exit conditions met, ABORT SEQUENCE
+        priority = pendingCritEnter();
+        current = (gen == seqGen[slot]);
+        if(current){
+            abortSequenceClear(slot);
+        }
+        pendingCritExit(priority);
+        if(current){
+            abortSequencePoll(slot, updating.status, time); //only the sequence needed interrupts held off
+            resetPayload();
+            beaconMsgUpdateSingle(SOFTWARE_STATE,'D');
+        }
+        return false;
+    }
+    if(mayRun && !jobPending(slot)){ //a command's background job has to finish before the next one runs
+        dprintf("Good!\r\nChecking wait conditons - ");
+        //then, if we did NOT exit, check the wait conditions of the next item in the sequence
+        if(!condWatchCached(COND_WATCH_WAIT(slot), &pendingCmd.wait, relBase, time, &result, &updating.status)){
+            uint16_t stamp = condWatchStamp();
+            result = checkConditions(&pendingCmd.wait, time, relBase, &updating.status);
+            condWatchArm(COND_WATCH_WAIT(slot), &pendingCmd.wait, relBase, time, stamp, result, updating.status);
+        }
+    }
+    if(!result){
+        dprintf("Wait conditions not satisfied currently\r\n");
+        if(exitFixed){
+            priority = pendingCritEnter();
+            if(gen == seqGen[slot]){
+                G_SET(csSequence[slot].exit, &exitCheck);
+                pollLogSeqState(slot, false);
+            }
+            pendingCritExit(priority);
+        }
+        return false;
+    }
+    //prepare the dequeue on the copy, and check if another item will be waiting with a relative time
+    BOOL recordTime = false;
+    seq_command_t nextCmd;
+    PendCmdQueue_Dequeue(&queueTemp, &pendingCmd); //mod
+    if(PendCmdQueue_Count(&queueTemp) > 0){
+        PendCmdQueue_Peek(&queueTemp, &nextCmd);
+        //if so, record the time so the delta can be calculated
+        recordTime = condUsesRelativeTime(nextCmd.wait.left) || (nextCmd.wait.op != JUST && condUsesRelativeTime(nextCmd.wait.right));
+    }
+
+    priority = pendingCritEnter();
+    current = (gen == seqGen[slot]);
+    if(current){
+        if(exitFixed){
+            G_SET(csSequence[slot].exit, &exitCheck);
+        }
+        G_SET(csSequence[slot].cmd_queue, &queueTemp); //write
+        if(recordTime){
+            G_SET(csSequence[slot].lastCmdTime, &time);
+        }
+        seqGen[slot]++;
+        derivedRefsChanged();
+        pollLogSeqState(slot, true);
+    }
+    pendingCritExit(priority);
+    if(!current){
+        dprintf("Sequence changed while it was checked\r\n");
+        return false; //checked again next time against whatever it is now
+    }
+    pollLogFlush(); //the dequeue is on the card before the command runs, so a reset never runs it twice
+
+    dprintf("Executing next pending command!\r\n");
+    updating.status = decodeAndRunPending(slot, pendingCmd);
+    updating.epoch = time;
+    updating.cmd_ID = pendingCmd.cmd_id;
+    updating.type = (updating.status == JOB_STATUS_RUNNING) ? PENDING : PENDING_COMPLETE;
+    updating.seqSlot = slot;
+    priority = pendingCritEnter();
+    respPollUpdatePending(updating);
+    pendingCritExit(priority);
+    //if something needs to be done when a sequence is empty, add that code here
+    return true;
+}
 
 /**
  * pendingProcess
  * INPUT: none
  * OUTPUT: none
  * INFO: The master function for pending command sequence execution.
- *       This function is called from the pending process state in the state status monitoring
- *       state machine once per second. While this should happen immediately after telemetry is
+ *       This function is called when the state status monitoring state machine handles EVENT_TELEMETRY,
+ *       once per second. While this should happen immediately after telemetry is
  *       recorded, and therefore should not interfere with the telemetry interrupt, it is not
- *       occurring within an interrupt and therefore is placed within an uninterrupted block (by adjusting the processor priority)
- *       to prevent any interrupts from happening during it and potentially leaving the satellite in an
- *       indeterminate or unsafe state.
+ *       occurring within an interrupt, so an interrupt could change a sequence while it is being worked on.
+ *       Conditions are evaluated and each change is prepared with interrupts enabled, against a copy of the
+ *       sequence. Only the changes themselves (the dequeue, an abort, the response poll update) are made in short
+ *       uninterruptible blocks (by adjusting the processor priority), and a change is dropped if the sequence's
+ *       generation shows it was changed since it was copied.
+ *
+ *       Up to NUM_SEQUENCES sequences run side by side, each in its own csSequence slot with its own queue, exit
+ *       conditions and last command time. The slots are visited round robin starting after the last one that ran
+ *       a command, and at most SEQ_TICK_BUDGET commands are run per call so one busy sequence can't starve the
+ *       others or hold the processor for long. Exit conditions are still checked for every slot on every call.
  *
+ *       For each slot (see pendingProcessSlot):
  *       A sequence is only "ready" if there are commands loaded and the ready flag is set to true
  *
  *       Exit conditions that are relative times are changed to absolute time exit conditions since
@@ -191,156 +437,33 @@ void decodeAndRunPending(seq_command_t cmd){
  *       anywhere within here (It's not quickly accessible because it may or may not be in the response poll that does
  *       not keep track of opcode. The link could've timed out as well).
  *
+ *       Exit and wait conditions are only evaluated when something they depend on has changed (see CScondWatch.c),
+ *       otherwise the result from the last time is used, so a sequence that is waiting costs almost nothing.
+ *
  *       The next item on the sequence is peeked at (to get a copy) so that we can quickly check the wait conditions after the exit conditions.
  *       Exit conditions are checked first since we do not want to continue to process a sequence if the exit conditions evaluate to TRUE.
  *           If they do evaluate to TRUE, the sequence is aborted and both response poll and the beacon is updated.
  *       Next the conditions of the next item in the sequence are checked. If they are false nothing happens to the sequence.
- *           If it evaluates to TRUE, that item is pulled off of the stack and executed, the response poll for it is updated, and if there are more
- *           commands, then the current time is stored as the last command time (for relative time checks).
- *       Since the pending process state is a special, transitory state in the state status response state machine, it needs to be put back into
- *       its previous mode so it may resume other operations.
- *
- *       Finally, the processor mode is returned to normal so interrupts may occur.
+ *           If it evaluates to TRUE, that item is pulled off of the stack, and if there are more commands with relative wait times,
+ *           the current time is stored as the last command time (for relative time checks). Then it is executed and the response poll for it is updated.
+ *       Every change made to the sequence is also appended to the poll log (CSpollLog.c) so it survives a reset.
+ *       Which derived signals the telemetry interrupt keeps (CSderived.c) is brought up to date before and after.
+ *       A command handed to a background job (CSjobs.c) is left PENDING in the response poll, and its sequence waits
+ *       for the job to finish before the next command's wait conditions are checked.
  */
 void pendingProcess(){
-    
-    //major issues could arise if the processing of the line is interrupted, especially due to the link being established
-    //Does not take long and occurs immediately after gathering telemetry so should not cause any issues.
-    //the contents of this function are as narrow as this window can be placed.
-    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
-
-    if( (Global->csSequence.cmd_queue.count > 0) && (Global->csSequence.seq_ready_flag != 0) /*&& (Link_GetMode() & ~(LINK_SEQUENCING | LINK_ACTIVE))*/){
-        //check the exit conditions and fix them if either is a relative time
-        uint32_t time = csunSatEpoch(getRTC());
-        dprintf("time = %ld\r\n", time);
-        conditions_t exitCheck = Global->csSequence.exit;
-        if(exitCheck.left.sensor_id == 254){ //change this to an absolute time value
-            dprintf("delta time  of %ld being changed -",exitCheck.left.value);
-            exitCheck.left.value += time;
-            dprintf("now absolute of %ld\r\n",exitCheck.left.value);
-            exitCheck.left.sensor_id = 255;
-            G_SET(csSequence.exit, &exitCheck);
-        }
-        if(exitCheck.op != JUST){//AND or OR is the operator, meaning right comparator is present
-            if(exitCheck.right.sensor_id == 254){ //change this to an absolute time value
-                exitCheck.right.value += time;
-                exitCheck.right.sensor_id = 255;
-                G_SET(csSequence.exit, &exitCheck);
-            }
-        }
-
-        dprintf("Checking pending Command sequence\r\n");
-        //going to place EXIT/WAIT checks for pending commands here.
-        resp_poll_t updating;
+    uint32_t time = Global->csLastTelemetry.epoch; //telemetry was just recorded, no need to read the RTC again
+    uint8_t budget = SEQ_TICK_BUDGET;
+    uint8_t start = seqNextSlot;
+    uint8_t i;
 
-        
-        seq_command_t pendingCmd;
-        PendCmdQueue_Peek(&Global->csSequence.cmd_queue, &pendingCmd);
-        
-        BOOL result = false;
-        //first check to see if we need to EXIT
-        //pull EXIT conditions
-        dprintf("Exit condition check - ");
-        exitCheck = Global->csSequence.exit;
-        //select the appropriate analysis depending on operator
-        switch(exitCheck.op){
-            case JUST:
-                result = checkCond(exitCheck.left);
-                updating.status = 1;
-                break;
-            case AND:
-                result = (checkCond(exitCheck.left) && checkCond(exitCheck.right));
-                updating.status = 2;
-                break;
-            case OR:
-                result = checkCond(exitCheck.left);
-                if(result){
-                    updating.status = 3;
-                }
-                result = result || checkCond(exitCheck.right);
-                if(result && updating.status != 3){
-                    updating.status = 4;
-                }
-                else if(result){
-                    updating.status = 5;
-                }
-                break;
-                //no default since these three cases are all possible values
-        }
-
-        if(result){
-            dprintf("ABORTING SEQUENCE!\r\n");
-            //if exit conditions met, ABORT SEQUENCE
-            resetPayload();
-            abortSequence(updating.status, time);
-            beaconMsgUpdateSingle(SOFTWARE_STATE,'D');
-        }
-        else{
-            dprintf("Good!\r\nChecking wait conditons - ");
-            result = false;
-            //then, if we did NOT exit, peek at the next item in the sequence
-            //break down the wait conditions and process according to JUST, AND, or OR
-            switch(pendingCmd.wait.op){
-                case JUST:
-                    result = checkCond(pendingCmd.wait.left);
-                    updating.status = 1;
-                    break;
-                case AND:
-                    result = (checkCond(pendingCmd.wait.left) && checkCond(pendingCmd.wait.right));
-                    updating.status = 2;
-                    break;
-                case OR:
-                    result = checkCond(pendingCmd.wait.left);
-                    if(result){
-                        updating.status = 3;
-                    }
-                    result = result || checkCond(pendingCmd.wait.right);
-                    if(result && updating.status != 3){
-                        updating.status = 4;
-                    }
-                    else if(result){
-                        updating.status = 5;
-                    }
-                    break;
-                    //no default since these three cases are all possible values
-            }
-                    //check to see if all necessary conditions have been met
-            if(result){
-                dprintf("Executing next pending command!\r\n");
-                //pop & do the next item in the sequence
-
-                PendCmdQueue queueTemp;
-                memcpy(&queueTemp, &Global->csSequence.cmd_queue, sizeof(queueTemp)); //read
-                PendCmdQueue_Dequeue(&queueTemp, &pendingCmd); //mod
-                G_SET(csSequence.cmd_queue, &queueTemp); //write
-                decodeAndRunPending(pendingCmd);
-                updating.epoch = time;
-                updating.cmd_ID = pendingCmd.cmd_id;
-                updating.type = PENDING_COMPLETE;
-                updating.status = 0;
-                respPollUpdatePending(updating);
-
-                //check if another item is waiting to be run
-                if(PendCmdQueue_Count(&Global->csSequence.cmd_queue) > 0){
-                    //if there is, check to see if the wait condition has a time
-                    PendCmdQueue_Peek(&Global->csSequence.cmd_queue, &pendingCmd);
-                    if(pendingCmd.wait.left.sensor_id == 254 || (pendingCmd.wait.op != JUST && pendingCmd.wait.right.sensor_id == 254)){
-                        //if so, record the time so the delta can be calculated
-                        G_SET(csSequence.lastCmdTime,&time);
-                    }
-                }
-                else{
-                    dprintf("Wait conditions not satisfied currently\r\n");
-                    //if something needs to be done when a sequence is empty, add that code here
-                }
-            }
+    derivedRefsUpdate(); //sequences loaded or programs changed since the last call
+    for(i = 0; i < NUM_SEQUENCES; i++){
+        uint8_t slot = (start + i) % NUM_SEQUENCES;
+        if(pendingProcessSlot(slot, time, (budget > 0))){
+            budget--;
+            seqNextSlot = (slot + 1) % NUM_SEQUENCES;
         }
     }
-    //go back to whatever type of sub state it was in before
-    if(Global->csState.statMonState == PENDING_PROCESS){
-        statMonStateToPrevious();
-    }
-    
-    //return processor to previous priority mode
-    Metal_SetCPUPriority(priority);
-}
\ No newline at end of file
+    derivedRefsUpdate(); //commands run and sequences aborted just now
+}
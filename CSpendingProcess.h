@@ -9,10 +9,18 @@
 #define	CSPENDINGPROCESS_H
 
 #include "CSpendingCommand.h"
+#include "metal/cpu.h"
 
-void abortSequence(uint8_t status, uint32_t time);
-BOOL checkCond(condition_t evaluating);
-void decodeAndRunPending(seq_command_t cmd);
+#define NUM_SEQUENCES   4 //command sequences that can be loaded and run side by side
+#define SEQ_TICK_BUDGET 2 //most pending commands run across every sequence in one pendingProcess call
+
+void abortSequence(uint8_t slot, uint8_t status, uint32_t time);
+BOOL checkCond(condition_t evaluating, uint32_t now, uint32_t relBase);
+uint8_t decodeAndRunPending(uint8_t slot, seq_command_t cmd);
+uint8_t sequenceUploadSlot(uint8_t slot);
 void pendingProcess();
+cpu_priority_t pendingCritEnter();
+void pendingCritExit(cpu_priority_t priority);
+
 #endif	/* CSPENDINGPROCESS_H */
 
@@ -0,0 +1,615 @@
+/*
+ * File:   CSpollLog.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * csResponsePoll and the csSequence slots only live in RAM, so a reset in the middle of a sequence used to lose
+ * both the completion history and the commands still queued. This file keeps them on the SD card as a
+ * snapshot plus an append-only log of every change made since it:
+ *
+ * - Every file is made of records: type (1 byte), payload length (2 bytes, MSB first), the payload,
+ *   then a Fletcher-16 of the type, length and payload (2 bytes, MSB first).
+ * - The log always starts with a POLL_LOG_GEN record naming the generation of the snapshot it applies to.
+ *   Each change to the poll or sequence appends one small record (see poll_log_type_t).
+ * - Snapshots alternate between two files, each one record of the next generation holding
+ *   csResponsePoll, csSequence, csCondProgram and csDerived one after another (see POLL_LOG_AREAS).
+ * - Once POLL_LOG_COMPACT_RECORDS records have been appended, a snapshot of the next generation is
+ *   written to the other file and the log is started over for it. A reset part way through leaves either
+ *   the old snapshot with a matching log or a complete new snapshot whose generation the old log no longer
+ *   matches, so nothing is ever applied twice.
+ *
+ * At boot pollLogRestore loads the newest valid snapshot and replays the matching log through the same
+ * functions that made the changes, stopping at the first incomplete record. If the newest snapshot can't be
+ * read back the other one is used, and the log, which no longer matches it, is folded into a new snapshot.
+ *
+ * Changing the poll or a sequence never waits on the card: appending only encodes the record into a RAM
+ * buffer and pushes EVENT_POLL_LOG. The main loop writes everything waiting in one go when it handles the
+ * event (see pollLogFlush), and the snapshot is written from there too when a compaction is due. So a change
+ * can be logged from an immediate command, or from inside a short uninterruptible section.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "debug.h"
+#include "CSopenSourceFAT.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+#include "CSresponsePoll.h"
+#include "CScondition.h"
+#include "CSderived.h"
+#include "CSpollLog.h"
+#include "CSjobs.h"
+#include "CSevents.h"
+
+//record header is type and length, trailer is the check
+#define POLL_LOG_HEADER_BYTES 3
+#define POLL_LOG_CHECK_BYTES  2
+
+typedef struct{
+    conditions_t exit;
+    uint32_t     lastCmdTime;
+    uint8_t      dequeued;
+    uint8_t      slot;
+} poll_log_seq_state_t;
+
+typedef struct{
+    global_ptr_t offset;
+    uint16_t size;
+} poll_log_area_t;
+
+//parts of the globals kept in a snapshot, in the order they are written
+static const poll_log_area_t POLL_LOG_AREAS[] = {
+    {G_OFFSET(csResponsePoll), sizeof(response_poll_t)},
+    {G_OFFSET(csSequence),     sizeof(((GlobalX*)NULL)->csSequence)},
+    {G_OFFSET(csCondProgram),  sizeof(cond_program_t)},
+    {G_OFFSET(csDerived),      sizeof(((GlobalX*)NULL)->csDerived)},
+};
+#define POLL_LOG_NUM_AREAS (sizeof(POLL_LOG_AREAS) / sizeof(POLL_LOG_AREAS[0]))
+
+static struct{
+    uint32_t gen;       //generation of the newest snapshot
+    uint16_t records;   //records appended to the log since that snapshot
+    BOOL     enabled;   //false until restored, and while replaying, so nothing is logged twice
+    BOOL     broken;    //a write failed, the log no longer covers the state in RAM
+    struct{
+        uint8_t  buf[POLL_LOG_BUFFER_BYTES]; //records appended since the last flush, ready to be written
+        uint16_t len;
+        BOOL     compact;   //a compaction is due at the next flush
+    } pend;
+} pollLog;
+
+/*
+ * pollLogSum
+ * INPUT: uint16_t* sum - running Fletcher-16, started at 0
+ *        uint8_t const* data - bytes to add
+ *        uint16_t len - number of bytes
+ * OUTPUT: none
+ */
+static void pollLogSum(uint16_t* sum, uint8_t const* data, uint16_t len){
+    uint16_t sum1 = (*sum & 0xFF);
+    uint16_t sum2 = (*sum >> 8);
+    while(len-- > 0){
+        sum1 = (sum1 + *data++) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    *sum = ((sum2 << 8) | sum1);
+}
+
+/*
+ * pollLogWriteRecord
+ * INPUT: FSFILE* file - open file to write to
+ *        uint8_t type - poll_log_type_t
+ *        uint8_t const* lead, uint8_t leadLen - start of the payload, may be NULL if leadLen is 0
+ *        void const* data - rest of the payload, may be NULL if len is 0
+ *        uint16_t len - length of the rest of the payload
+ * OUTPUT: BOOL - true if the whole record was written
+ * INFO: The payload is taken in two parts so a sequence can be written straight out of the globals
+ *       after its slot number.
+ */
+static BOOL pollLogWriteRecord(FSFILE* file, uint8_t type, uint8_t const* lead, uint8_t leadLen,
+                               void const* data, uint16_t len){
+    uint8_t head[POLL_LOG_HEADER_BYTES];
+    uint8_t check[POLL_LOG_CHECK_BYTES];
+    uint16_t sum = 0;
+    BOOL ok = true;
+    head[0] = type;
+    head[1] = (leadLen + len) >> 8;
+    head[2] = (leadLen + len);
+    pollLogSum(&sum, head, sizeof(head));
+    pollLogSum(&sum, lead, leadLen);
+    pollLogSum(&sum, data, len);
+    check[0] = sum >> 8;
+    check[1] = sum;
+    ok &= (FSfwrite(head, sizeof(head), 1, file) == 1);
+    if(leadLen > 0){
+        ok &= (FSfwrite(lead, leadLen, 1, file) == 1);
+    }
+    if(len > 0){
+        ok &= (FSfwrite(data, len, 1, file) == 1);
+    }
+    ok &= (FSfwrite(check, sizeof(check), 1, file) == 1);
+    return ok;
+}
+
+/*
+ * pollLogReadRecord
+ * INPUT: FSFILE* file - open file positioned at the start of a record
+ *        uint8_t* type - returns the poll_log_type_t
+ *        uint16_t* len - returns the payload length
+ * OUTPUT: BOOL - true if a complete record with a good check follows, in which case the file is
+ *         left at the start of its payload. False at the end of the file or on a damaged record.
+ * INFO: The payload is read through once in small pieces to check it, so records of any size can be
+ *       checked without a buffer to hold them.
+ */
+static BOOL pollLogReadRecord(FSFILE* file, uint8_t* type, uint16_t* len){
+    uint8_t head[POLL_LOG_HEADER_BYTES];
+    uint8_t buf[32];
+    uint16_t sum = 0;
+    uint16_t left;
+    long start;
+    if(FSfread(head, sizeof(head), 1, file) != 1){
+        return false;
+    }
+    pollLogSum(&sum, head, sizeof(head));
+    *type = head[0];
+    *len = ((uint16_t)head[1] << 8) | head[2];
+    start = FSftell(file);
+    for(left = *len; left > 0;){
+        uint16_t chunk = (left > sizeof(buf)) ? sizeof(buf) : left;
+        if(FSfread(buf, chunk, 1, file) != 1){
+            return false;
+        }
+        pollLogSum(&sum, buf, chunk);
+        left -= chunk;
+    }
+    if(FSfread(buf, POLL_LOG_CHECK_BYTES, 1, file) != 1){
+        return false;
+    }
+    if((((uint16_t)buf[0] << 8) | buf[1]) != sum){
+        return false;
+    }
+    return (FSfseek(file, start, SEEK_SET) == 0);
+}
+
+/*
+ * pollLogNextRecord
+ * INPUT: FSFILE* file - open file somewhere in a record's payload
+ *        long payloadStart - position of the start of the payload
+ *        uint16_t len - payload length of the record
+ * OUTPUT: none
+ * INFO: Moves past whatever is left of the record's payload and its check.
+ */
+static void pollLogNextRecord(FSFILE* file, long payloadStart, uint16_t len){
+    FSfseek(file, payloadStart + len + POLL_LOG_CHECK_BYTES, SEEK_SET);
+}
+
+/*
+ * pollLogReadGlobal
+ * INPUT: FSFILE* file - open file positioned at the data
+ *        size_t offset - offset into GlobalX of where the data goes
+ *        uint16_t len - number of bytes
+ * OUTPUT: BOOL - true if it was all read
+ * INFO: Copies straight from the file into the globals in small pieces.
+ */
+static BOOL pollLogReadGlobal(FSFILE* file, size_t offset, uint16_t len){
+    uint8_t buf[32];
+    while(len > 0){
+        uint16_t chunk = (len > sizeof(buf)) ? sizeof(buf) : len;
+        if(FSfread(buf, chunk, 1, file) != 1){
+            return false;
+        }
+        globalMod(offset, buf, chunk);
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+/*
+ * pollLogSnapshotSize
+ * INPUT: none
+ * OUTPUT: uint16_t - payload length of a snapshot record, the generation followed by every area
+ */
+static uint16_t pollLogSnapshotSize(){
+    uint16_t len = sizeof(uint32_t);
+    uint8_t i;
+    for(i = 0; i < POLL_LOG_NUM_AREAS; i++){
+        len += POLL_LOG_AREAS[i].size;
+    }
+    return len;
+}
+
+/*
+ * pollLogSnapshotName
+ * INPUT: uint32_t gen - snapshot generation
+ * OUTPUT: const char* - file the snapshot of that generation is kept in
+ */
+static const char* pollLogSnapshotName(uint32_t gen){
+    return (gen & 1) ? POLL_LOG_SNAPSHOT_B : POLL_LOG_SNAPSHOT_A;
+}
+
+/*
+ * pollLogSnapshotGen
+ * INPUT: const char* name - snapshot file
+ *        uint32_t* gen - returns its generation
+ * OUTPUT: BOOL - true if the file holds a complete snapshot of the current layout
+ */
+static BOOL pollLogSnapshotGen(const char* name, uint32_t* gen){
+    uint8_t type;
+    uint16_t len;
+    BOOL ok = false;
+    FSFILE* file = FSfopen(name, "r");
+    if(file == NULL){
+        return false;
+    }
+    if(pollLogReadRecord(file, &type, &len) && (type == POLL_LOG_GEN)
+            && (len == pollLogSnapshotSize())){
+        ok = (FSfread(gen, sizeof(uint32_t), 1, file) == 1);
+    }
+    FSfclose(file);
+    return ok;
+}
+
+/*
+ * pollLogReplay
+ * INPUT: FSFILE* file - log positioned at the payload of a record
+ *        uint8_t type - poll_log_type_t of the record
+ *        uint16_t len - payload length
+ * OUTPUT: BOOL - false if the record does not make sense, which ends the replay
+ * INFO: Applies one logged change through the same function that originally made it.
+ */
+static BOOL pollLogReplay(FSFILE* file, uint8_t type, uint16_t len){
+    union{
+        resp_poll_t item;
+        uint16_t u16;
+        poll_log_abort_t abort;
+        poll_log_seq_state_t state;
+        uint8_t u8;
+        uint8_t code[COND_PROGRAM_SIZE];
+    } rec;
+    if(type == POLL_LOG_SEQ_LOAD){
+        uint8_t slot;
+        if((len != (1 + sizeof(sequence_t))) || (FSfread(&slot, 1, 1, file) != 1) || (slot >= NUM_SEQUENCES)){
+            return false;
+        }
+        return pollLogReadGlobal(file, G_OFFSET(csSequence[slot]), sizeof(sequence_t));
+    }
+    if((len > sizeof(rec)) || ((len > 0) && (FSfread(&rec, len, 1, file) != 1))){
+        return false;
+    }
+    switch(type){
+        case POLL_LOG_CLEAR:
+            initResponsePoll();
+            break;
+        case POLL_LOG_ENQUEUE:
+            respPollEnqueue(rec.item);
+            break;
+        case POLL_LOG_UPDATE:
+            respPollUpdatePending(rec.item);
+            break;
+        case POLL_LOG_USER_DELETE:
+            respPollUserDelete(rec.u16);
+            break;
+        case POLL_LOG_SYS_DELETE:
+            respPollSysDelete(rec.u8);
+            break;
+        case POLL_LOG_COND_LOAD:
+            condProgramLoad(rec.code, len);
+            break;
+        case POLL_LOG_DERIVED:
+            if(len != 4){
+                return false;
+            }
+            derivedSet(rec.code[0], rec.code[1], rec.code[2], rec.code[3]);
+            break;
+        case POLL_LOG_ACK:
+            respPollAck(rec.u16);
+            break;
+        case POLL_LOG_ABORT:
+            abortSequence(rec.abort.slot, rec.abort.status, rec.abort.time);
+            break;
+        case POLL_LOG_SEQ_STATE:
+            if(rec.state.slot >= NUM_SEQUENCES){
+                return false;
+            }
+            if(rec.state.dequeued){
+                PendCmdQueue queueTemp;
+                seq_command_t cmd;
+                memcpy(&queueTemp, &Global->csSequence[rec.state.slot].cmd_queue, sizeof(queueTemp)); //read
+                PendCmdQueue_Dequeue(&queueTemp, &cmd); //mod
+                G_SET(csSequence[rec.state.slot].cmd_queue, &queueTemp); //write
+            }
+            G_SET(csSequence[rec.state.slot].exit, &rec.state.exit);
+            G_SET(csSequence[rec.state.slot].lastCmdTime, &rec.state.lastCmdTime);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/*
+ * pollLogLoadSnapshot
+ * INPUT: uint32_t gen - generation of the snapshot to load
+ * OUTPUT: BOOL - true if every area was read back from it
+ * INFO: A false return can leave the areas partly loaded, so the caller has to load something else over them.
+ */
+static BOOL pollLogLoadSnapshot(uint32_t gen){
+    uint8_t type;
+    uint16_t len;
+    uint32_t fileGen;
+    uint8_t i;
+    BOOL ok;
+    FSFILE* file = FSfopen(pollLogSnapshotName(gen), "r");
+    if(file == NULL){
+        return false;
+    }
+    ok = pollLogReadRecord(file, &type, &len) && (type == POLL_LOG_GEN) && (len == pollLogSnapshotSize())
+            && (FSfread(&fileGen, sizeof(fileGen), 1, file) == 1) && (fileGen == gen);
+    for(i = 0; ok && (i < POLL_LOG_NUM_AREAS); i++){
+        ok = pollLogReadGlobal(file, POLL_LOG_AREAS[i].offset, POLL_LOG_AREAS[i].size);
+    }
+    FSfclose(file);
+    return ok;
+}
+
+/*
+ * pollLogRestore
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called once, on the first pass of status monitoring, which startup only hands over to once the SD card
+ *       is up and before a link session can have changed the poll (see statusMonitoringStateMachine).
+ *       Loads the newest complete snapshot, falling back to the other one if it can't be read back, then replays
+ *       every record of the log made against it. If neither can be loaded the areas are cleared instead.
+ *       Logging is off until this has run so the boot time initialization is not logged over the
+ *       state being restored. If the log could not be used completely the state is compacted into a
+ *       fresh snapshot straight away.
+ */
+void pollLogRestore(){
+    uint32_t genA = 0;
+    uint32_t genB = 0;
+    BOOL haveA = pollLogSnapshotGen(POLL_LOG_SNAPSHOT_A, &genA);
+    BOOL haveB = pollLogSnapshotGen(POLL_LOG_SNAPSHOT_B, &genB);
+    BOOL loaded = false;
+    BOOL clean = false;
+    FSFILE* file;
+    uint8_t type;
+    uint16_t len;
+
+    pollLog.enabled = false;
+    pollLog.records = 0;
+    pollLog.broken = false;
+    pollLog.pend.len = 0;
+    pollLog.pend.compact = false;
+    pollLog.gen = 0;
+    if(haveA || haveB){
+        BOOL newestA = haveA && (!haveB || (genA > genB));
+        pollLog.gen = newestA ? genA : genB;
+        loaded = pollLogLoadSnapshot(pollLog.gen);
+        if(!loaded && haveA && haveB){
+            dprintf("Poll snapshot %lu unreadable, using the older one\r\n", pollLog.gen);
+            pollLog.gen = newestA ? genB : genA;
+            loaded = pollLogLoadSnapshot(pollLog.gen);
+        }
+    }
+    if(!loaded){
+        uint8_t i;
+        for(i = 0; i < POLL_LOG_NUM_AREAS; i++){
+            globalMod(POLL_LOG_AREAS[i].offset, NULL, POLL_LOG_AREAS[i].size);
+        }
+        //keep the generation past both files so the next snapshot replaces the oldest
+        pollLog.gen = (genA > genB) ? genA : genB;
+    }
+    respPollIndexRebuild(); //the replay looks items up by command ID
+
+    if(loaded){
+        file = FSfopen(POLL_LOG_FILE, "r");
+        if(file != NULL){
+            uint32_t gen;
+            if(pollLogReadRecord(file, &type, &len) && (type == POLL_LOG_GEN) && (len == sizeof(gen))
+                    && (FSfread(&gen, sizeof(gen), 1, file) == 1) && (gen == pollLog.gen)){
+                FSfseek(file, POLL_LOG_CHECK_BYTES, SEEK_CUR);
+                clean = true;
+                while(pollLogReadRecord(file, &type, &len)){
+                    long start = FSftell(file);
+                    if(!pollLogReplay(file, type, len)){
+                        clean = false;
+                        break;
+                    }
+                    pollLogNextRecord(file, start, len);
+                    pollLog.records++;
+                }
+            }
+            FSfclose(file);
+        }
+    }
+    respPollIndexRebuild();
+    condProgramIndex();
+    derivedRefsChanged();
+    dprintf("Response poll restored from snapshot %lu and %u log records\r\n", pollLog.gen, pollLog.records);
+
+    pollLog.enabled = true;
+    if(!clean){
+        pollLogCompact(); //also covers the first boot, when there is nothing to restore
+    }
+}
+
+/*
+ * pollLogCompact
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Writes the current response poll and sequence as the next generation's snapshot, into the file
+ *       not holding the current one, then starts an empty log for it. The snapshot holds every change still
+ *       waiting to be written, so those records are dropped. Does nothing before pollLogRestore has run.
+ */
+void pollLogCompact(){
+    uint32_t gen = pollLog.gen + 1;
+    BOOL ok;
+    FSFILE* file;
+    if(!pollLog.enabled){
+        return;
+    }
+    pollLog.pend.len = 0;
+    pollLog.pend.compact = false;
+    file = FSfopen(pollLogSnapshotName(gen), "w");
+    if(file == NULL){
+        pollLog.broken = true;
+        return;
+    }
+    //the generation followed by every area, written as one record
+    {
+        uint8_t head[POLL_LOG_HEADER_BYTES];
+        uint8_t check[POLL_LOG_CHECK_BYTES];
+        uint16_t sum = 0;
+        uint16_t len = pollLogSnapshotSize();
+        uint8_t i;
+        head[0] = POLL_LOG_GEN;
+        head[1] = len >> 8;
+        head[2] = len;
+        pollLogSum(&sum, head, sizeof(head));
+        pollLogSum(&sum, (uint8_t const*)&gen, sizeof(gen));
+        for(i = 0; i < POLL_LOG_NUM_AREAS; i++){
+            pollLogSum(&sum, (uint8_t const*)Global + POLL_LOG_AREAS[i].offset, POLL_LOG_AREAS[i].size);
+        }
+        check[0] = sum >> 8;
+        check[1] = sum;
+        ok = (FSfwrite(head, sizeof(head), 1, file) == 1);
+        ok &= (FSfwrite(&gen, sizeof(gen), 1, file) == 1);
+        for(i = 0; i < POLL_LOG_NUM_AREAS; i++){
+            ok &= (FSfwrite((uint8_t const*)Global + POLL_LOG_AREAS[i].offset, POLL_LOG_AREAS[i].size, 1, file) == 1);
+        }
+        ok &= (FSfwrite(check, sizeof(check), 1, file) == 1);
+    }
+    FSfclose(file);
+    if(!ok){
+        pollLog.broken = true;
+        return;
+    }
+    file = FSfopen(POLL_LOG_FILE, "w");
+    if(file == NULL){
+        pollLog.broken = true;
+        return;
+    }
+    ok = pollLogWriteRecord(file, POLL_LOG_GEN, NULL, 0, &gen, sizeof(gen));
+    FSfclose(file);
+    pollLog.gen = gen;
+    pollLog.records = 0;
+    pollLog.broken = !ok;
+}
+
+/*
+ * pollLogAppendRecord
+ * INPUT: poll_log_type_t type - what changed
+ *        uint8_t const* lead, uint8_t leadLen - start of the payload
+ *        void const* data, uint16_t len - rest of the payload
+ * OUTPUT: none
+ * INFO: Nothing is logged before pollLogRestore has run or while it is replaying. Otherwise the record is
+ *       encoded into the buffer exactly as pollLogWriteRecord would write it, and pollLogFlush is asked for.
+ *       If it doesn't fit, the log can't be trusted any more, or it has grown long enough, a compaction is
+ *       left for pollLogFlush instead, since the snapshot it writes will hold every change made in the meantime.
+ */
+static void pollLogAppendRecord(poll_log_type_t type, uint8_t const* lead, uint8_t leadLen, void const* data, uint16_t len){
+    uint8_t* rec = &pollLog.pend.buf[pollLog.pend.len];
+    uint16_t payload = leadLen + len;
+    uint16_t sum = 0;
+    if(!pollLog.enabled){
+        return;
+    }
+    eventPush(EVENT_POLL_LOG, 0);
+    if(pollLog.pend.compact){
+        return;
+    }
+    if(pollLog.broken || (pollLog.records >= POLL_LOG_COMPACT_RECORDS)
+            || (pollLog.pend.len + POLL_LOG_HEADER_BYTES + payload + POLL_LOG_CHECK_BYTES > POLL_LOG_BUFFER_BYTES)){
+        pollLog.pend.compact = true;
+        return;
+    }
+    rec[0] = type;
+    rec[1] = payload >> 8;
+    rec[2] = payload;
+    if(leadLen > 0){
+        memcpy(&rec[POLL_LOG_HEADER_BYTES], lead, leadLen);
+    }
+    if(len > 0){
+        memcpy(&rec[POLL_LOG_HEADER_BYTES + leadLen], data, len);
+    }
+    pollLogSum(&sum, rec, POLL_LOG_HEADER_BYTES + payload);
+    rec[POLL_LOG_HEADER_BYTES + payload] = sum >> 8;
+    rec[POLL_LOG_HEADER_BYTES + payload + 1] = sum;
+    pollLog.pend.len += POLL_LOG_HEADER_BYTES + payload + POLL_LOG_CHECK_BYTES;
+    pollLog.records++;
+}
+
+/*
+ * pollLogAppend
+ * INPUT: poll_log_type_t type - what changed
+ *        void const* data - payload of the record
+ *        uint16_t len - payload length
+ * OUTPUT: none
+ * INFO: Called by each function that changes the response poll or a sequence, after the change is made.
+ */
+void pollLogAppend(poll_log_type_t type, void const* data, uint16_t len){
+    pollLogAppendRecord(type, NULL, 0, data, len);
+}
+
+/*
+ * pollLogSeqLoad
+ * INPUT: uint8_t slot - csSequence slot a sequence was just uploaded to
+ * OUTPUT: none
+ */
+void pollLogSeqLoad(uint8_t slot){
+    pollLogAppendRecord(POLL_LOG_SEQ_LOAD, &slot, 1, &Global->csSequence[slot], sizeof(sequence_t));
+}
+
+/*
+ * pollLogSeqState
+ * INPUT: uint8_t slot - csSequence slot that changed
+ *        BOOL dequeued - true if the head of the sequence was taken off the queue
+ * OUTPUT: none
+ * INFO: Logs a change pendingProcess made to a sequence, along with the exit conditions and last command
+ *       time as they are now, so a replay doesn't depend on the time it is run.
+ */
+void pollLogSeqState(uint8_t slot, BOOL dequeued){
+    poll_log_seq_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.exit = Global->csSequence[slot].exit;
+    state.lastCmdTime = Global->csSequence[slot].lastCmdTime;
+    state.dequeued = dequeued;
+    state.slot = slot;
+    pollLogAppend(POLL_LOG_SEQ_STATE, &state, sizeof(state));
+}
+
+/*
+ * pollLogFlush
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called from the main loop for EVENT_POLL_LOG. Writes every record appended since the last flush with one
+ *       open, write and close, or compacts if that is due. While a background job has the SD card the records
+ *       stay in the buffer and the event is pushed again, so they are written once the job is done.
+ */
+void pollLogFlush(){
+    FSFILE* file;
+    if(jobSDBusy()){
+        eventPush(EVENT_POLL_LOG, 0); //the job's own steps keep the main loop awake meanwhile
+        return;
+    }
+    if(pollLog.pend.compact){
+        pollLogCompact();
+        return;
+    }
+    if(pollLog.pend.len == 0){
+        return;
+    }
+    file = FSfopen(POLL_LOG_FILE, "a");
+    if(file == NULL){
+        pollLog.broken = true;
+    }
+    else{
+        if(FSfwrite(pollLog.pend.buf, pollLog.pend.len, 1, file) != 1){
+            pollLog.broken = true;
+        }
+        FSfclose(file);
+    }
+    pollLog.pend.len = 0;
+}
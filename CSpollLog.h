@@ -0,0 +1,51 @@
+/*
+ * File:   CSpollLog.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Nonvolatile log of the response poll and command sequence, see CSpollLog.c
+ */
+
+#ifndef CSPOLLLOG_H
+#define	CSPOLLLOG_H
+
+#include <stdint.h>
+#include "types.h"
+
+#define POLL_LOG_FILE            "POLLLOG.DAT"
+#define POLL_LOG_SNAPSHOT_A      "POLLSNPA.DAT"
+#define POLL_LOG_SNAPSHOT_B      "POLLSNPB.DAT"
+#define POLL_LOG_COMPACT_RECORDS 64  //records appended before the log is folded into a new snapshot
+#define POLL_LOG_BUFFER_BYTES    256 //records that can wait in RAM for pollLogFlush
+
+typedef enum{
+    POLL_LOG_GEN         = 1, //first record of every log, uint32_t generation of the snapshot it applies to
+    POLL_LOG_CLEAR       = 2, //initResponsePoll
+    POLL_LOG_ENQUEUE     = 3, //respPollEnqueue, resp_poll_t
+    POLL_LOG_UPDATE      = 4, //respPollUpdatePending, resp_poll_t
+    POLL_LOG_USER_DELETE = 5, //respPollUserDelete, uint16_t command ID
+    POLL_LOG_ACK         = 6, //respPollAck, uint16_t sequence number
+    POLL_LOG_ABORT       = 7, //abortSequence, poll_log_abort_t
+    POLL_LOG_SEQ_LOAD    = 8, //a complete sequence was uploaded, uint8_t slot followed by its sequence_t
+    POLL_LOG_SEQ_STATE   = 9, //pendingProcess changed a sequence, poll_log_seq_state_t
+    POLL_LOG_SYS_DELETE  = 10, //respPollSysDelete, uint8_t index
+    POLL_LOG_COND_LOAD   = 11, //condProgramLoad, the program code
+    POLL_LOG_DERIVED     = 12, //derivedSet, uint8_t index, sensor, kind and window
+} poll_log_type_t;
+
+typedef struct{
+    uint32_t time;
+    uint8_t  status;
+    uint8_t  slot;
+} poll_log_abort_t;
+
+void pollLogRestore();
+void pollLogAppend(poll_log_type_t type, void const* data, uint16_t len);
+void pollLogSeqLoad(uint8_t slot);
+void pollLogSeqState(uint8_t slot, BOOL dequeued);
+void pollLogCompact();
+void pollLogFlush();
+
+#endif	/* CSPOLLLOG_H */
+
@@ -11,18 +11,207 @@
 #include "debug.h"
 #include "CScommandParser.h"
 #include "CSi2c.h"
+#include "CSpollLog.h"
+#include "CSderived.h"
+#include "CSjobs.h"
+
+//slot of the i-th oldest item in the poll
+#define RESP_POLL_SLOT(i) ((Global->csResponsePoll.tail + (i)) % RESP_POLL_SIZE)
+
+//true if sequence number a was issued after b, allowing for the counter wrapping
+#define RESP_SEQ_AFTER(a, b) ((int16_t)((uint16_t)(a) - (uint16_t)(b)) > 0)
+
+//cmd_ID index entries hold slot+1 so that 0 can mean empty
+#define RESP_INDEX_EMPTY    0x00
+#define RESP_INDEX_REMOVED  0xFF
+
+/*
+ * Open addressing (linear probing) index from cmd_ID to the poll slot holding it, so pending
+ * commands can be found without scanning the poll. It is derived entirely from csResponsePoll,
+ * so it is kept out of the globals and simply rebuilt whenever it may not match them: after the
+ * poll is compacted or rebuilt, or if the poll's tail/used no longer match what it was built against
+ * (for instance after an upset was settled).
+ * Removed entries are never reused until the next rebuild. This keeps items with the same cmd_ID
+ * in the probe chain oldest first, and since every slot in use holds at most one entry the index
+ * never gets more than half full.
+ */
+static struct{
+    uint8_t entry[RESP_POLL_INDEX_SIZE];
+    uint8_t tail;  //csResponsePoll.tail the index was built against
+    uint8_t used;  //csResponsePoll.used the index was built against
+    BOOL    valid;
+} respIndex;
+
+static uint16_t respAbortIDs[RESP_POLL_SIZE]; //command IDs respPollAbort is re-adding, main loop only
+
+/*
+ * respIndexHome
+ * INPUT: uint16_t ID - command ID
+ * RETURN: uint8_t - first index entry to probe for the command ID
+ * INFO: Multiplicative hash so the mostly sequential command IDs are spread over the index.
+ */
+static uint8_t respIndexHome(uint16_t ID){
+    return ((uint16_t)(ID * 40503u)) >> (16 - RESP_POLL_INDEX_BITS);
+}
+
+/*
+ * respIndexInsert
+ * INPUT: uint16_t ID - command ID of the item
+ *        uint8_t slot - slot of the poll_queue holding it
+ * RETURN: none
+ * INFO: Adds the item at the end of its probe chain.
+ */
+static void respIndexInsert(uint16_t ID, uint8_t slot){
+    uint8_t e = respIndexHome(ID);
+    while(respIndex.entry[e] != RESP_INDEX_EMPTY){
+        e = (e + 1) & (RESP_POLL_INDEX_SIZE - 1);
+    }
+    respIndex.entry[e] = slot + 1;
+}
+
+/*
+ * respPollIndexRebuild
+ * INPUT: none
+ * RETURN: none
+ * INFO: Rebuilds the cmd_ID index from the poll, oldest item first.
+ */
+void respPollIndexRebuild(){
+    uint8_t i;
+    memset(respIndex.entry, RESP_INDEX_EMPTY, sizeof(respIndex.entry));
+    for(i=0; i<Global->csResponsePoll.used; i++){
+        uint8_t slot = RESP_POLL_SLOT(i);
+        if(Global->csResponsePoll.poll_queue[slot].type != RESP_POLL_DELETED){
+            respIndexInsert(Global->csResponsePoll.poll_queue[slot].cmd_ID, slot);
+        }
+    }
+    respIndex.tail = Global->csResponsePoll.tail;
+    respIndex.used = Global->csResponsePoll.used;
+    respIndex.valid = true;
+}
+
+/*
+ * respPollFind
+ * INPUT: uint16_t ID - command ID to look for
+ * RETURN: int16_t - slot of the oldest item with that command ID that has not been deleted, -1 if there is none
+ * INFO: Every hit is checked against the poll itself. If the index points at anything else it can no longer
+ *       be trusted, so it is rebuilt and the lookup is done again.
+ */
+static int16_t respPollFind(uint16_t ID){
+    uint8_t attempt;
+    for(attempt=0; attempt<2; attempt++){
+        uint8_t e;
+        uint8_t probes;
+        BOOL stale = false;
+        if(!respIndex.valid || (respIndex.tail != Global->csResponsePoll.tail) || (respIndex.used != Global->csResponsePoll.used)){
+            respPollIndexRebuild();
+        }
+        e = respIndexHome(ID);
+        for(probes=0; (probes<RESP_POLL_INDEX_SIZE) && (respIndex.entry[e] != RESP_INDEX_EMPTY); probes++){
+            if(respIndex.entry[e] != RESP_INDEX_REMOVED){
+                uint8_t slot = respIndex.entry[e] - 1;
+                resp_poll_t const* item = &Global->csResponsePoll.poll_queue[slot];
+                if((slot >= RESP_POLL_SIZE) || (item->type == RESP_POLL_DELETED)){
+                    stale = true;
+                    break;
+                }
+                if(item->cmd_ID == ID){
+                    return slot;
+                }
+            }
+            e = (e + 1) & (RESP_POLL_INDEX_SIZE - 1);
+        }
+        if(!stale){
+            return -1;
+        }
+        respIndex.valid = false;
+    }
+    return -1;
+}
 
 /*
  * initResponsePoll
  * INPUT: none
  * RETURN: none
  * INFO:
- * Clears the reponse poll stores in Globals
+ * Clears the reponse poll stores in Globals. The sequence number is left alone so the ground's
+ * cursor (see respPollResponseSince) stays valid across a clear.
  */
 void initResponsePoll(){
-    G_SET(csResponsePoll.head, NULL);
+    G_SET(csResponsePoll.tail, NULL);
+    G_SET(csResponsePoll.used, NULL);
+    respPollIndexRebuild();
+    pollLogAppend(POLL_LOG_CLEAR, NULL, 0);
 }
 
+/*
+ * respPollTombstone
+ * INPUT: uint8_t slot - slot of the poll_queue to be deleted
+ * RETURN: none
+ * INFO:
+ * Deleting only marks the item, which is a single write no matter where it is in the poll.
+ * The slot is reclaimed the next time the poll is compacted (see respPollCompact). Its cmd_ID
+ * index entry is removed as well.
+ */
+static void respPollTombstone(uint8_t slot){
+    resp_poll_t item = Global->csResponsePoll.poll_queue[slot];
+    if(respIndex.valid){
+        uint8_t e = respIndexHome(item.cmd_ID);
+        uint8_t probes;
+        for(probes=0; (probes<RESP_POLL_INDEX_SIZE) && (respIndex.entry[e] != RESP_INDEX_EMPTY); probes++){
+            if(respIndex.entry[e] == (slot + 1)){
+                respIndex.entry[e] = RESP_INDEX_REMOVED;
+                break;
+            }
+            e = (e + 1) & (RESP_POLL_INDEX_SIZE - 1);
+        }
+    }
+    item.type = RESP_POLL_DELETED;
+    G_SET(csResponsePoll.poll_queue[slot], &item);
+}
+
+/*
+ * respPollCompact
+ * INPUT: none
+ * RETURN: none
+ * INFO:
+ * Called when every slot of the poll is in use, or when items were just deleted. The items that have not
+ * been deleted are moved up in place, in order, behind the oldest one. An item is only ever moved to a slot
+ * nearer the tail, which has already been read, and only the items that actually move are written. If nothing
+ * had been deleted the oldest immediate command, if there are any, is dropped to make room (see respPollEnqueue).
+ * The tail stays where it is and 'used' is written last.
+ */
+static void respPollCompact(){
+    uint8_t used = Global->csResponsePoll.used;
+    uint8_t i;
+    uint8_t n = 0;
+    BOOL dropImmediate = true;
+    //only drop an immediate command if there is nothing to reclaim
+    for(i=0; i<used; i++){
+        if(Global->csResponsePoll.poll_queue[RESP_POLL_SLOT(i)].type == RESP_POLL_DELETED){
+            dropImmediate = false;
+            break;
+        }
+    }
+    for(i=0; i<used; i++){
+        resp_poll_t item = Global->csResponsePoll.poll_queue[RESP_POLL_SLOT(i)];
+        if(item.type == RESP_POLL_DELETED){
+            continue;
+        }
+        if(dropImmediate && (item.type == IMMEDIATE)){
+            dropImmediate = false;
+            continue;
+        }
+        if(n != i){
+            G_SET(csResponsePoll.poll_queue[RESP_POLL_SLOT(n)], &item);
+        }
+        n++;
+    }
+    if(n == used){
+        return; //full of pending commands, nothing to be done
+    }
+    G_SET(csResponsePoll.used, &n);
+    respIndex.valid = false; //items moved
+}
 
 /*
  *respPollUserDelete
@@ -32,92 +221,92 @@ void initResponsePoll(){
  *         a pending command
  * INFO:
  * Called by on_RESPONSE_POLL_CLEAR in CScommandParser.c when the command ID given is NOT 0xFFFF (the command ID
- * for erasing the entire response poll). Two boolean values are utilized to signify the two
- * conditions that must be met to allow deletion - existance in the respone poll and
- * being deletable.
- * 1. Response poll is checked to see if the command ID matches the ID of any stored commands.
- *  - If found the found boolean is marked as true.
- * 2. If found, the command's type is checked. If it's immediate or pending complete
- *    the delete boolean is set to true. If the pending command is pending, delete
- *    is left as false - don't want to let the ground delete an individual pending command.
- * 3. If the item is able to be deleted, then it is done so and all other items in the
- *    response poll are moved appropriately.
- * 4. The appropriate return value is selected depending upon the conditions that were met during
- *    the function execution.
- *
+ * for erasing the entire response poll). Two conditions must be met to allow deletion - existance in the
+ * respone poll and being deletable.
+ * 1. The cmd_ID index is used to find the oldest stored command with a matching command ID.
+ * 2. If found, the command's type is checked. If it's immediate or pending complete it is deleted.
+ *    If the pending command is pending it is left alone - don't want to let the ground delete an
+ *    individual pending command.
+ * 3. The appropriate return value is selected depending upon the conditions that were met.
  */
 uint8_t respPollUserDelete(uint16_t ID){
-    uint8_t i;
-    BOOL found = false;
-    BOOL delete = false;
-    //find the index with the parcitular command ID
-    for(i=0;(i < Global->csResponsePoll.head)&&(!found); i++){
-        //once found
-        if( Global->csResponsePoll.poll_queue[i].cmd_ID == ID ){
-            found = true;
-            //verify it's not a pending command waiting to be executed.
-            if(Global->csResponsePoll.poll_queue[i].type != PENDING ){
-                delete = true;
-                i--;//handle shuffle in secondary loop
-            }
-        }
-    }
-    //if the item is to be deleted, shuffle down all other records, minus where the new head will be, since its data doesn't matter
-    if(delete){
-        for(;i<(Global->csResponsePoll.head - 1);i++){
-            G_SET(csResponsePoll.poll_queue[i],&(Global->csResponsePoll.poll_queue[i+1]));
-        }
-        uint8_t newHead = (Global->csResponsePoll.head -1);
-        G_SET(csResponsePoll.head, &newHead);
-    }
-    if(found && delete){
-        return 0; //all went well
+    //find the slot with the parcitular command ID
+    int16_t slot = respPollFind(ID);
+    if(slot < 0){
+        return 0xFF; //item was not found
     }
-    else if(found){
+    //verify it's not a pending command waiting to be executed.
+    if(Global->csResponsePoll.poll_queue[slot].type == PENDING){
         return 0xFE; //item was a pending command, not deleted
     }
-    else{
-        return 0xFF; //item was not found
-    }
-
+    respPollTombstone(slot);
+    pollLogAppend(POLL_LOG_USER_DELETE, &ID, sizeof(ID));
+    return 0; //all went well
 }
 
 
 /*
  *respPollSysDelete
- * INPUT: uint8_t index - index of the response poll item to be deleted
+ * INPUT: uint8_t index - index of the response poll item to be deleted, 0 being the oldest
  * RETURN: BOOL - true if an item was in the index and was deleted, false if it did not exist
  * INFO:
- * Used by the system for removing items. This function is used only by the system to either
- * delete immediate commands when the response poll is full or as part of a pending command
- * update process.
- * Starting at the given index, assuming it's a currently valid index, all items after (newer) than
- * it are shifted back by 1 slot and true is returned. If somehow an invalid index is passed, then
- * false is returned.
+ * Used by the system for removing items. The item is marked as deleted in place, nothing is shifted.
+ * If somehow an invalid index, or one that was already deleted, is passed then false is returned.
  */
 BOOL respPollSysDelete(uint8_t index){
-    uint8_t i;
     //error check to make sure it's a valid index given
-    if(index <= Global->csResponsePoll.head){
-        for(i=index;i<(Global->csResponsePoll.head - 1);i++){
-                G_SET(csResponsePoll.poll_queue[i],&(Global->csResponsePoll.poll_queue[i+1]));
+    if(index < Global->csResponsePoll.used){
+        uint8_t slot = RESP_POLL_SLOT(index);
+        if(Global->csResponsePoll.poll_queue[slot].type != RESP_POLL_DELETED){
+            respPollTombstone(slot);
+            pollLogAppend(POLL_LOG_SYS_DELETE, &index, sizeof(index));
+            return true;
         }
-        uint8_t newHead = (Global->csResponsePoll.head -1);
-        G_SET(csResponsePoll.head, &newHead);
-        return true;
     }
     return false;
 }
 
-//add a new item, if the poll is full, will need to find and delete the oldest pending that has not been executed.
+/*
+ * respPollAdd
+ * INPUT: resp_poll_t newest - a response poll item.
+ * RETURN: none
+ * INFO:
+ * Does the work of respPollEnqueue without logging it, for callers that log the whole change themselves.
+ */
+static void respPollAdd(resp_poll_t newest){
+    //check to see if the buffer's full. if so, reclaim space
+    if(Global->csResponsePoll.used == RESP_POLL_SIZE){
+        respPollCompact();
+    }
+    //if there is room enqueue the item.
+    if(Global->csResponsePoll.used < RESP_POLL_SIZE){
+        uint8_t used = Global->csResponsePoll.used;
+        uint8_t slot = RESP_POLL_SLOT(used);
+        uint16_t seq = Global->csResponsePoll.nextSeq;
+        newest.seq = seq;
+        G_SET(csResponsePoll.poll_queue[slot],&newest); //enqueue new item
+        seq++;
+        G_SET(csResponsePoll.nextSeq,&seq);
+        used++;
+        G_SET(csResponsePoll.used,&used); //bump up the newest end
+        //keep the index in step, otherwise it is rebuilt on the next lookup
+        if(respIndex.valid && (respIndex.used == (used - 1))){
+            respIndexInsert(newest.cmd_ID, slot);
+            respIndex.used = used;
+        }
+    }
+}
+
 /*
  *respPollEnqueue
  * INPUT: resp_poll_t newest - a response poll item.
  * RETURN: none
  * INFO:
- * Adds a response poll item to the queue. If the queue is full then the oldest immediate
- * command, if there are any, is deleted. If there is now room the item is added to the
- * poll. Otherwise nothing happens.
+ * Adds a response poll item to the newest end of the circular buffer. If every slot is in use the poll
+ * is compacted first, which reclaims deleted slots or, if there are none, deletes the oldest immediate
+ * command. If there is now room the item is given the next sequence number and added to the poll.
+ * Otherwise nothing happens. Since items are only ever added at the newest end, the poll is always in
+ * sequence number order.
  * the input data is not checked for validity because the additional processing and memory
  * overhead necessary was decided to be unnecessary, though the only real validity check would
  * be to have this function set the time value. Due to the nature of updating pending commands
@@ -132,29 +321,14 @@ BOOL respPollSysDelete(uint8_t index){
  * commands is left to the discression of the ground station. With the size of the response poll it is
  * unlikely for it to become completely full of pending commands unless the ground completely forgets
  * to clear it.
+ * The item is logged to the SD card (see CSpollLog.c) along with the change.
  */
 void respPollEnqueue(resp_poll_t newest){
-    //check to see if the buffer's full. if so, find the oldest erasable command
-    if(Global->csResponsePoll.head == (sizeof(Global->csResponsePoll.poll_queue)/sizeof(Global->csResponsePoll.poll_queue[0]))){
-        uint8_t i;
-        uint8_t head = Global->csResponsePoll.head;
-        //find the first non-pending command
-        for(i=0; i<head; i++){
-            if(Global->csResponsePoll.poll_queue[i].type == IMMEDIATE){
-                respPollSysDelete(i); //delete it
-                i = head; //end the loop
-            }
-        }
-    }
-    //if there is room enqueue the item.
-    if(Global->csResponsePoll.head < (sizeof(Global->csResponsePoll.poll_queue)/sizeof(Global->csResponsePoll.poll_queue[0]))){
-        uint8_t head = Global->csResponsePoll.head;
-        G_SET(csResponsePoll.poll_queue[head],&newest); //enqueue new item
-        head++;
-        G_SET(csResponsePoll.head,&head); //bump up the head
-    }
+    respPollAdd(newest);
+    pollLogAppend(POLL_LOG_ENQUEUE, &newest, sizeof(newest));
 }
 
+
 //update a pending command due to its execution
 /*
  * respPollUpdatePending
@@ -170,51 +344,75 @@ void respPollEnqueue(resp_poll_t newest){
  * of the code in order to allow faster execution.
  */
 void respPollUpdatePending(resp_poll_t update){
-    uint8_t i;
-    uint8_t head = Global->csResponsePoll.head;
     //find the pending command to be updated
-    for(i=0; i<head; i++){
-        if(Global->csResponsePoll.poll_queue[i].cmd_ID == update.cmd_ID){
-            //remove the original version due to its changed status
-            respPollSysDelete(i);
-            i = head;
-        }
+    int16_t slot = respPollFind(update.cmd_ID);
+    if(slot >= 0){
+        //remove the original version due to its changed status
+        respPollTombstone(slot);
     }
     //enequeue the executed verison
-    respPollEnqueue(update);
+    respPollAdd(update);
+    pollLogAppend(POLL_LOG_UPDATE, &update, sizeof(update));
 }
 
 
 //when an abort occurs in a sequence all of the pending commands that were NOT executed must be updated to reflect this.
 /*
  * respPollAbort
- * INPUT: uint8_t status - status code corresponding to the abort condition (SEE pendingProcess() in CSpendingProcess.c)
+ * INPUT: uint8_t slot - csSequence slot of the sequence that was aborted
+ *        uint8_t status - status code corresponding to the abort condition (SEE pendingProcess() in CSpendingProcess.c)
  *        uint32_t time - CSUNsatEpoch time value
  * RETURN: none
- * INFO: Updates any PENDING item in the response poll to a PENDING_COMPLETE with a negative of the status given.
- * Because only one sequence can be uploaded at any given time it is unnecessary to check to see if the command IDs
- * are part of the current sequence. Time is passed into the function because it is always called where the time has
+ * INFO: Updates any PENDING item of the aborted sequence in the response poll to a PENDING_COMPLETE with a negative of the
+ * status given. Items are matched to the sequence by their seqSlot tag, other sequences are left running. Time is passed into the function because it is always called where the time has
  * already been requested and the number of I2C calls needs to be kept to a minimum in order to keep processes as efficient
  * as possible.
  * An abort line is added to the response poll to explicitly show the time where the abort occurred and under which conditions.
+ * Its command ID is RESP_POLL_ABORT_ID - slot so the ground can tell which sequence it was.
  * Afterwards all pending commands are updated to reflect them being aborted at this time.
+ * This is the same as enqueueing the abort line and calling respPollUpdatePending for each unexecuted command,
+ * done in place: the unexecuted commands are deleted, their command IDs kept in respAbortIDs, then the abort line
+ * and the aborted commands are added. If the poll is full of pending commands there is no room for the abort line
+ * and it is left out, rather than one of the aborted commands.
+ * A command handed to a job shows JOB_STATUS_RUNNING until the job reports it, which it still does after the
+ * abort. If the slot has no job the item can't be reported any more, so it is aborted along with the rest.
  */
-void respPollAbort(uint8_t status, uint32_t time){
+void respPollAbort(uint8_t slot, uint8_t status, uint32_t time){
     resp_poll_t abortLine;
+    uint8_t i;
+    uint8_t aborted = 0;
+    uint8_t live = 0;
+    BOOL immediate = false;
     abortLine.epoch = time;
     abortLine.type = PENDING_COMPLETE;
     abortLine.status = 0 - status; //mirror negative values for ABORT cause
-    abortLine.cmd_ID = 0xFFFE; //using 0xFFFE for abort
-    respPollEnqueue(abortLine);
-    uint16_t i;
-    //go through each and update each unexecuted pending and update that it was aborted
-    for(i=0;i<Global->csResponsePoll.head;i++){
-        //if it's an unexecuted pending command
-        if((Global->csResponsePoll.poll_queue[i].type == PENDING)&&(Global->csResponsePoll.poll_queue[i].status == 42)){
-            abortLine.cmd_ID = Global->csResponsePoll.poll_queue[i].cmd_ID; //set the command ID (abortLine already is set to PENDING_COMPLETE and status 0xFF
-            respPollUpdatePending(abortLine);
-            i--; //step back i so it checks the same spot again, since the queue was shifted with the delete
+    abortLine.cmd_ID = RESP_POLL_ABORT_ID - slot;
+    abortLine.seqSlot = slot;
+
+    for(i=0; i<Global->csResponsePoll.used; i++){
+        uint8_t s = RESP_POLL_SLOT(i);
+        resp_poll_t const* item = &Global->csResponsePoll.poll_queue[s];
+        if(item->type == RESP_POLL_DELETED){
+            continue;
+        }
+        live++;
+        if(item->type == IMMEDIATE){
+            immediate = true;
         }
+        else if((item->type == PENDING) && (item->seqSlot == slot) &&
+                ((item->status == 42) || ((item->status == JOB_STATUS_RUNNING) && !jobPending(slot)))){
+            respAbortIDs[aborted] = item->cmd_ID;
+            aborted++;
+            respPollTombstone(s);
+        }
+    }
+    if((live < RESP_POLL_SIZE) || immediate){
+        respPollAdd(abortLine);
+    }
+    //go through each unexecuted pending command and update that it was aborted
+    for(i=0; i<aborted; i++){
+        abortLine.cmd_ID = respAbortIDs[i]; //abortLine already is set to PENDING_COMPLETE and the abort status
+        respPollAdd(abortLine);
     }
 }
 
@@ -226,27 +424,159 @@ void respPollAbort(uint8_t status, uint32_t time){
  * RETURN: uint16_t - tells the number of characters utilized
  * (technically  also char * telem, which houses a copy of all of the data from the response poll
  * INFO:
- * Takes each item from the response poll and moves it into the character array. takes each byte of a given
- * response poll item and packs it into the character array that will be sent to the ground. The type of command
- * is not sent since this data is unnecessary and would waste precious telemetry bandwidth - all pending commands
+ * Takes each item from the response poll, oldest first, and moves it into the character array. takes each byte of a given
+ * response poll item and packs it into the character array that will be sent to the ground. Deleted items are skipped.
+ * The type of command is not sent since this data is unnecessary and would waste precious telemetry bandwidth - all pending commands
  * that have not been executed have a status of 42, which is not used by any other type of command.
  */
 uint16_t respPollResponse(char* telem){
-    uint16_t i;
+    uint8_t i;
+    uint16_t n = 0;
     //iterate through each one
-    for(i=0;i<Global->csResponsePoll.head;i++){
-        telem[(i*7)+0] = Global->csResponsePoll.poll_queue[i].cmd_ID >> 8; //MSB first
-        telem[(i*7)+1] = Global->csResponsePoll.poll_queue[i].cmd_ID;
-        telem[(i*7)+2] = Global->csResponsePoll.poll_queue[i].status;
-        telem[(i*7)+3] = Global->csResponsePoll.poll_queue[i].epoch >> 24;
-        telem[(i*7)+4] = Global->csResponsePoll.poll_queue[i].epoch >> 16;
-        telem[(i*7)+5] = Global->csResponsePoll.poll_queue[i].epoch >> 8;
-        telem[(i*7)+6] = Global->csResponsePoll.poll_queue[i].epoch;
+    for(i=0;i<Global->csResponsePoll.used;i++){
+        resp_poll_t const* item = &Global->csResponsePoll.poll_queue[RESP_POLL_SLOT(i)];
+        if(item->type == RESP_POLL_DELETED){
+            continue;
+        }
+        telem[n+0] = item->cmd_ID >> 8; //MSB first
+        telem[n+1] = item->cmd_ID;
+        telem[n+2] = item->status;
+        telem[n+3] = item->epoch >> 24;
+        telem[n+4] = item->epoch >> 16;
+        telem[n+5] = item->epoch >> 8;
+        telem[n+6] = item->epoch;
+        n += 7;
     }
     //return the number of characters used
-    i = (i*7);
-    return i;
+    return n;
+}
+/*
+ * respPollPutVarint
+ * INPUT: char* telem - where to write
+ *        uint32_t val - value to be written
+ * RETURN: uint8_t - number of characters utilized (1-5)
+ * INFO: Little endian base 128, 7 bits per byte with the MSB set on every byte but the last.
+ */
+static uint8_t respPollPutVarint(char* telem, uint32_t val){
+    uint8_t n = 0;
+    while(val >= 0x80){
+        telem[n++] = (val & 0x7F) | 0x80;
+        val >>= 7;
+    }
+    telem[n++] = val;
+    return n;
+}
+
+/*
+ * respPollZigZag
+ * INPUT: int32_t delta - signed difference between two records
+ * RETURN: uint32_t - delta folded so small negative values also stay small (0,-1,1,-2... become 0,1,2,3...)
+ */
+static uint32_t respPollZigZag(int32_t delta){
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
 }
+
+/*
+ * respPollResponseSince
+ * INPUT: char * telem - character array utilized to send data to the ground
+ *        uint16_t maxLen - number of characters available in telem
+ *        uint16_t since - sequence number of the newest item the ground already has
+ *        uint8_t flags - RESP_POLL_ALL to ignore 'since', RESP_POLL_COMPACT for the compact record format
+ * RETURN: uint16_t - tells the number of characters utilized
+ * INFO:
+ * Incremental version of respPollResponse. The first two bytes (MSB first) are the ground's new cursor: the sequence
+ * number of the newest item sent, which the ground passes back as 'since' on its next request. Only the items added
+ * after 'since' follow, oldest first and as many as fit in maxLen. An executed or aborted pending command is re-added
+ * to the poll, so its new status always shows up as a new item. Because the poll is kept in sequence number order the
+ * newer items are simply found from the newest end backwards.
+ * Records are the same 7 bytes as respPollResponse unless RESP_POLL_COMPACT is set. Compact records are the status byte
+ * followed by the command ID and then the epoch, each as a zigzag varint of the difference from the previous record
+ * (the first record is against 0). Consecutive records usually have sequential IDs and close epochs, so most take 3-4 bytes.
+ */
+uint16_t respPollResponseSince(char* telem, uint16_t maxLen, uint16_t since, uint8_t flags){
+    uint16_t cursor = since;
+    uint16_t prevID = 0;
+    uint32_t prevEpoch = 0;
+    uint16_t n = 2;
+    uint8_t first = Global->csResponsePoll.used;
+    uint8_t i;
+    if(maxLen < 2){
+        return 0;
+    }
+    //walk back to the oldest item the ground doesn't have yet
+    if(flags & RESP_POLL_ALL){
+        first = 0;
+    }
+    while(first > 0){
+        resp_poll_t const* item = &Global->csResponsePoll.poll_queue[RESP_POLL_SLOT(first - 1)];
+        if((item->type != RESP_POLL_DELETED) && !RESP_SEQ_AFTER(item->seq, since)){
+            break;
+        }
+        first--;
+    }
+    for(i=first; i<Global->csResponsePoll.used; i++){
+        resp_poll_t const* item = &Global->csResponsePoll.poll_queue[RESP_POLL_SLOT(i)];
+        if(item->type == RESP_POLL_DELETED){
+            continue;
+        }
+        if((n + ((flags & RESP_POLL_COMPACT) ? RESP_POLL_COMPACT_MAX : 7)) > maxLen){
+            break; //rest goes in the next response
+        }
+        if(flags & RESP_POLL_COMPACT){
+            telem[n++] = item->status;
+            n += respPollPutVarint(&telem[n], respPollZigZag((int16_t)(item->cmd_ID - prevID)));
+            n += respPollPutVarint(&telem[n], respPollZigZag((int32_t)(item->epoch - prevEpoch)));
+            prevID = item->cmd_ID;
+            prevEpoch = item->epoch;
+        }
+        else{
+            telem[n+0] = item->cmd_ID >> 8; //MSB first
+            telem[n+1] = item->cmd_ID;
+            telem[n+2] = item->status;
+            telem[n+3] = item->epoch >> 24;
+            telem[n+4] = item->epoch >> 16;
+            telem[n+5] = item->epoch >> 8;
+            telem[n+6] = item->epoch;
+            n += 7;
+        }
+        cursor = item->seq;
+    }
+    //everything was sent, deleted items included
+    if(i == Global->csResponsePoll.used){
+        cursor = Global->csResponsePoll.nextSeq - 1;
+    }
+    telem[0] = cursor >> 8;
+    telem[1] = cursor;
+    return n;
+}
+
+/*
+ * respPollAck
+ * INPUT: uint16_t seq - newest sequence number the ground has received
+ * RETURN: uint8_t - number of items removed from the poll
+ * INFO:
+ * Lets the ground acknowledge what it has already received instead of clearing the poll. Every immediate
+ * and completed pending command up to and including 'seq' is removed, unexecuted pending commands are always
+ * kept. The items are deleted in place and the poll is only compacted if anything was removed.
+ */
+uint8_t respPollAck(uint16_t seq){
+    uint8_t i;
+    uint8_t removed = 0;
+    for(i=0; i<Global->csResponsePoll.used; i++){
+        uint8_t slot = RESP_POLL_SLOT(i);
+        resp_poll_t const* item = &Global->csResponsePoll.poll_queue[slot];
+        if((item->type != RESP_POLL_DELETED) && (item->type != PENDING) && !RESP_SEQ_AFTER(item->seq, seq)){
+            respPollTombstone(slot);
+            removed++;
+        }
+    }
+    if(removed > 0){
+        respPollCompact();
+        pollLogAppend(POLL_LOG_ACK, &seq, sizeof(seq));
+    }
+    return removed;
+}
+
 /*
  *commandParserResponsePollEnqueue
  * INPUT: link_command_t* cmd - used to get the comand ID and opcode
@@ -258,6 +588,7 @@ uint16_t respPollResponse(char* telem){
  * moved around in the command parser. The command ID is stored away, since this has a large number of possible
  * values, it is unlikely for the satellite to receive two commands with the same ID before the buffer is emptied.
  * Time is not obtained during most commands, therefore it is obtained within the function.
+ * Pending commands are tagged with the sequence slot they are being loaded into (csSequenceUpload).
  */
 void commandParserResponsePollEnqueue(link_command_t* cmd, link_response_t* response){
     resp_poll_t newItem;
@@ -266,13 +597,18 @@ void commandParserResponsePollEnqueue(link_command_t* cmd, link_response_t* resp
     newItem.epoch = timeBuf;
     newItem.type = IMMEDIATE;
     newItem.status = response->status;
+    newItem.seqSlot = 0;
     //if it was any of the pending commands, mark it as such
     if((command_list[cmd->opcode].allowed_modes & LINK_SEQUENCING) || cmd->opcode==OP_START_SEQUENCE){//any of the pending commands
+        uint8_t slot = Global->csSequenceUpload;
         newItem.type = PENDING;
         newItem.status = 42;
+        newItem.seqSlot = slot;
         //if it was an END SEQUENCE store away the proper time. done here so that we only use ONE getRTC call per command processed
         if(cmd->opcode==OP_END_SEQUENCE){
-            G_SET(csSequence.lastCmdTime, &timeBuf);
+            G_SET(csSequence[slot].lastCmdTime, &timeBuf);
+            pollLogSeqLoad(slot);
+            derivedRefsChanged(); //the new sequence may compare derived signals
         }
     }
     respPollEnqueue(newItem);
@@ -14,10 +14,22 @@
 #include "CSlink.h"
 #include "CScommandParser.h"
 
+#define RESP_POLL_SIZE 66             //at most 253 since the cmd_ID index stores slot+1 in a byte
+#define RESP_POLL_INDEX_BITS 7
+#define RESP_POLL_INDEX_SIZE (1 << RESP_POLL_INDEX_BITS) //keep at least twice RESP_POLL_SIZE
+
+#define RESP_POLL_ABORT_ID 0xFFFE //command ID of the abort line for sequence slot s is RESP_POLL_ABORT_ID - s
+
+//flags for respPollResponseSince
+#define RESP_POLL_ALL          0x01 //send the whole poll, ignoring the cursor
+#define RESP_POLL_COMPACT      0x02 //delta/varint records instead of fixed 7 byte records
+#define RESP_POLL_COMPACT_MAX  9    //longest compact record: status, 3 byte ID delta, 5 byte epoch delta
+
 typedef enum{
-    IMMEDIATE        = 0,
-    PENDING          = 1,
-    PENDING_COMPLETE = 2,
+    IMMEDIATE         = 0,
+    PENDING           = 1,
+    PENDING_COMPLETE  = 2,
+    RESP_POLL_DELETED = 3, //tombstone left by a delete until the poll is compacted
 }response_cmd_type_t;
 
 typedef struct{
@@ -25,20 +37,27 @@ typedef struct{
     uint16_t cmd_ID;
     response_cmd_type_t type :8;
     uint8_t  status;
+    uint16_t seq;     //set when enqueued, increases with every item added to the poll
+    uint8_t  seqSlot; //csSequence slot a pending command belongs to, 0 for immediate commands
 } resp_poll_t;
 
 typedef struct{
-    resp_poll_t poll_queue[66];
-    uint8_t     head;
+    resp_poll_t poll_queue[RESP_POLL_SIZE];
+    uint16_t    nextSeq; //sequence number the next enqueued item gets
+    uint8_t     tail;    //slot of the oldest item
+    uint8_t     used;    //number of slots in use, deleted items included
 } response_poll_t;
 
 void    initResponsePoll();
+void    respPollIndexRebuild();
 uint8_t respPollUserDelete(uint16_t ID);
 BOOL respPollSysDelete(uint8_t index);
 void respPollEnqueue(resp_poll_t newest);
 void respPollUpdatePending(resp_poll_t update);
-void respPollAbort(uint8_t status, uint32_t time);
+void respPollAbort(uint8_t slot, uint8_t status, uint32_t time);
 uint16_t respPollResponse(char* telem);
+uint16_t respPollResponseSince(char* telem, uint16_t maxLen, uint16_t since, uint8_t flags);
+uint8_t respPollAck(uint16_t seq);
 void commandParserResponsePollEnqueue(link_command_t* cmd, link_response_t* response);
 
 #endif	/* CSRESPONSEPOLL_H */
@@ -10,8 +10,14 @@
 #include "CSresponsePoll.h"
 #include "CSpendingProcess.h"
 #include "CStimers.h"
+#include "CStimerWheel.h"
 #include "CScubesat.h"
 #include "CSbeacon.h"
+#include "CSjobs.h"
+#include "CSidle.h"
+#include "CSevents.h"
+#include "CSdiagnostic.h"
+#include "CSpollLog.h"
 
 #include "delay.h"
 /*
@@ -51,14 +57,21 @@
  * long and bulky.
  *
  * The first of these is done by being triggered on a regular basis by telemetry processing.
- * Each time telemetry is processed (in the interrupt). it changes this state machine to
- * PENDING_PROCESS.
+ * Each time telemetry is processed (in the interrupt) it pushes EVENT_TELEMETRY, which this
+ * state machine handles before the work of whichever state it is in (see CSevents.c).
  *
  * The second is done via timer driven state changes. When the satellite has been in
  * the ALL_QUIET state for 2.5 minutes, the interrupt it triggered and changes the sate to BEACON_ON
  *
  * The third is done by passing through the DIAGNOSTIC_CHECK state and by validating that a diagnostic
- * check has not been done on that day. If it has not and it is the designated time (hour), it is performed.
+ * check has not been done on that day. If it has not, it is started, and it is then run a small step at a time
+ * while ALL_QUIET has nothing else to do (see CSdiagnostic.c).
+ *
+ * The single timer is no longer shared: ALL_QUIET and BEACON_ON each have their own software timer on the
+ * timer wheel (see CStimerWheel.c), so a state only has to look at its own timer to know it was just entered.
+ * Sequence processing no longer takes over the state either: it used to be a fourth, PENDING_PROCESS, that the
+ * telemetry interrupt switched to and pendingProcess switched back from, and an interrupt that moved the state
+ * on in between could be lost.
  */
 /* Type and Constant Definitions*/
 //static BOOL demo3InitFlag                =        1;
@@ -66,6 +79,10 @@
 static uint32_t const BEACON_ON_TIME     =    40000u; //beacon is on for 30 seconds
 static uint32_t const ALL_QUIET_TIME     =   140000u; //all quiet is for 150 seconds
 
+static timer_wheel_t statMonQuietTimer;  //running while ALL_QUIET waits for the beacon to be due
+static timer_wheel_t statMonBeaconTimer; //running while BEACON_ON waits for the transmission to be done
+static BOOL statMonRestored;             //the response poll and sequences were restored from the SD card
+
 
 /*
  * changeStatMonState
@@ -88,25 +105,23 @@ void changeStatMonState(StatMonState newState){
  * OUTPUT: none
  * INFO:
  * Very simple - changes the status monitoring state machine to diagnostic check
- * mode and disables the timer.
- * Utilized by the timer when the end of the beacon on state is complete
+ * mode.
+ * Utilized by the beacon timer when the end of the beacon on state is complete
  */
 void statMonStateDiagnosticCheck(){
     changeStatMonState(DIAGNOSTIC_CHECK);
-    G_SET(csState.timerMode,NULL);
 }
 /*
  * statMonStateAllQuiet
  * INPUT: none
  * OUTPUT: none
  * INFO:
- * Very simple - changes the status monitoring state machine to diagnostic check
- * mode and disables the timer.
+ * Very simple - changes the status monitoring state machine to all quiet
+ * mode.
  * Called directly at the end of the Diagnostic Check state.
  */
 void statMonStateAllQuiet(){
     changeStatMonState(ALL_QUIET);
-    G_SET(csState.timerMode,NULL);
 }
 
 /*
@@ -114,13 +129,11 @@ void statMonStateAllQuiet(){
  * INPUT: none
  * OUTPUT: none
  * INFO:
- * Very simple - changes the status monitoring state machine to beacon on mode
- * and disables the timer.
- * Utilized by the timer when the end of the all quiet state is complete
+ * Very simple - changes the status monitoring state machine to beacon on mode.
+ * Utilized by the all quiet timer when the end of the all quiet state is complete
  */
 void statMonStateBeaconOn(){
     changeStatMonState(BEACON_ON);
-    G_SET(csState.timerMode,NULL);
 }
 
 /*
@@ -129,8 +142,6 @@ void statMonStateBeaconOn(){
  * OUTPUT: none
  * INFO:
  * Very simple - changes the status monitoring state machine to its previous mode
- * Called at the very end of the pending process state in order to return to the
- * current main state
  */
 void statMonStateToPrevious(){
     StatMonState reverting = Global->csState.statMonPrevState;
@@ -138,87 +149,116 @@ void statMonStateToPrevious(){
 }
 
 
+/*
+ * statMonDiagFailed
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: A check of the daily diagnostic failed, it has been reported in basic telemetry. Goes to anomaly.
+ */
+static void statMonDiagFailed(){
+    MainState new = ANOMALY;
+    G_SET(csState.previousState,&Global->csState.mainState);
+    G_SET(csState.mainState,&new);
+}
+
 /**
  * Handles the state and actions of the cubesat during normal operation.
  * Considered the "default state" after initialization.
+ * The very first pass restores the response poll and the sequences from the SD card (see CSpollLog.c),
+ * since startup has brought the card up by then and nothing has changed them yet, then reports any job the
+ * reset cut short (see jobsRestore in CSjobs.c).
+ * Power saving options are turned off then and at each DIAGNOSTIC_CHECK, once a beacon cycle, rather than on
+ * every pass, since the processor now dozes between passes and would otherwise set them again on every wake.
+ * Each pass first handles the highest priority event waiting, if there is one, as the state machine of every
+ * main state has to (see CSevents.c):
+ *  EVENT_TELEMETRY - Pushed once each second after telemetry processing. If there
+ *                    is a sequence to be processed it is handled here.
+ *  EVENT_DOWNLINK_FLUSH - Downlink items packed into a frame (see CSdownlink.c) have
+ *                    waited long enough and are sent.
+ *  EVENT_FLUSH_DUE, EVENT_FLUSH_TICK - The telemetry buffer is written to the SD card.
+ *  EVENT_JOB_STEP  - Background jobs (see CSjobs.c) take one step.
+ *  EVENT_POLL_LOG  - Changes to the response poll and sequences are written to the SD card.
+ * Otherwise the pass does the work of the state.
  * state information:
- *  DIAGNOSTIC_CHECK - once a day a diagnostic check will be performed. Otherwise
- *                     nothing happens.
+ *  DIAGNOSTIC_CHECK - power saving options are turned off, and once a day a
+ *                     diagnostic check is started.
  * ALL_QUET - If the beacon has not been disabled during BEACON ON, disables it
  *            when it is safe to do so and return the antenna to the radio. Otherwise
- *            the satellite is quiet and does nothing special.
- * PENDING_PROCESS - The satellite is toggled over to this state once each second,
- *                   after telemetry processing. If there is a sequence to be
- *                   processed it is handled here. After an individual pass through
- *                   this state this state machine reverts to the state it was in
- *                   previoiusly.
- * BEACON_ON - Beacon is powered on, the beacon string is updated while waiting
- *             for it to fully power up, and then it is updated. The timer is then
+ *            a running diagnostic takes its next step, and if there is none
+ *            the satellite is quiet and the processor dozes until the next
+ *            interrupt (see CSidle.c). A failed diagnostic goes to anomaly.
+ * BEACON_ON - Beacon is powered on and the beacon string, which is kept up to
+ *             date each second by the telemetry path, is sent. The beacon timer is then
  *             utilized to make sure that we stay in this state until the transmission
  *             should be complete because the radio and beacon CANNOT utilize the
  *             antenna at the same time. If the beacon does finish during this state,
- *             turn it off and return the antenna to the radio.
+ *             turn it off and return the antenna to the radio. While waiting the
+ *             processor dozes until the next interrupt.
  */
 void statusMonitoringStateMachine(){
 
     //static uint16 statusMonitoringState = 0;
 
-    powerSavingOff();//turns off any power saving options
+    if(!statMonRestored){
+        powerSavingOff();//turns off any power saving options
+        pollLogRestore();
+        jobsRestore();
+        statMonRestored = true;
+        return;
+    }
+    if(eventDispatch()){
+        return;
+    }
     switch( Global->csState.statMonState ){
         case DIAGNOSTIC_CHECK : {
             dprintf("Diagnostic check\r\n");
-            bool diagResult = true;
-#if 0
-            uint8_t day = (getRTC()>> 32);
-            if(day != Global->csState.diagDay){
-                diagResult = CubeSat_SpawnDiagnostician();
-                G_SET(csState.diagDay,&day);
-            }
-#endif
-            if(diagResult){
-                statMonStateAllQuiet();
-            } else { // Error found in diagnostic check.
-                MainState new = ANOMALY;
-                G_SET(csState.previousState,&Global->csState.mainState);
-                G_SET(csState.mainState,&new);
+            powerSavingOff();
+            uint8_t day = (uint8_t)(csunSatEpoch(getRTC()) / 86400ul); //only compared to the last day it ran
+            if((day != Global->csState.diagDay) && !diagRunning()){
+                diagStart(day); //run in steps during ALL_QUIET
             }
+            statMonStateAllQuiet();
         } break;
         case ALL_QUIET : {
             /*TODO: When radio side code is complete, check to see if the beacon is off
             and the antenna has been returned to the radio. If not, do it if it's
             possible. Otherwise throw anomaly.*/
             //sit in all quiet mode for 150 seconds, then go to Beacon On
-            if((Global->csState.timerMode == OFF) && Global->csState.statMonState == ALL_QUIET){
+            if(!timerWheelPending(&statMonQuietTimer)){
                 dprintf("Setting timer in All quiet\r\n");
                 
                 beaconPowerOff();
 
-                setTimeout(ALL_QUIET_TIME,&statMonStateBeaconOn, STATUS_MONITOR);
+                timerWheelStart(&statMonQuietTimer, ALL_QUIET_TIME, &statMonStateBeaconOn);
             }
             else{
+                diag_status_t diag = diagStep();
+                if(diag == DIAG_FAILED){
+                    statMonDiagFailed();
+                }
+                else if(diag == DIAG_IDLE){
+                    idleUntilDue(ALL_QUIET); //until telemetry, the beacon timer or a radio event
+                }
             }
         } break;
-        case PENDING_PROCESS: {
-            pendingProcess();
-        }break;
         case BEACON_ON : {
-            if((Global->csState.timerMode == OFF) && Global->csState.statMonState == BEACON_ON){
+            if(!timerWheelPending(&statMonBeaconTimer)){
                 dprintf("Setting timer in beacon on\r\n");
                 if(Global->csBeacon.beacon_enabled){
-                    
+                    //the beacon string is kept current by the telemetry path
                     beaconPowerOn();
 
-                    beaconMsgUpdateTelemetry();
                     dprintf(Global->csBeacon.beaconMsg);
                     dprintf("\r\n");
 #if BEACON_OUT
                     beaconSend();
 #endif
                 }
-                setTimeout(BEACON_ON_TIME,&statMonStateDiagnosticCheck, STATUS_MONITOR);
+                timerWheelStart(&statMonBeaconTimer, BEACON_ON_TIME, &statMonStateDiagnosticCheck);
             }
             else{
             //TODO: check to see if the beacon is done and it's OK to return the antenna to the radio.
+                idleUntilDue(BEACON_ON);
             }
         } break;
         default : {
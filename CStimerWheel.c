@@ -0,0 +1,263 @@
+/*
+ * File:   CStimerWheel.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * There is only the one hardware timer behind setTimeout, which is why status monitoring used to share a
+ * single timeout between its states and poll csState.timerMode to see whether it was free. The timer wheel
+ * puts any number of software timers on top of it. Whoever needs a timeout keeps a timer_wheel_t of its own
+ * and starts or cancels it at any time, in constant time no matter how many are running.
+ *
+ * The wheel counts time in ticks of TIMER_WHEEL_TICK_MS. It has TIMER_WHEEL_LEVELS levels of
+ * 1 << TIMER_WHEEL_BITS slots, each slot a list of the timers due in it:
+ * - Level 0 holds the timers due within the next 64 ticks, one slot per tick.
+ * - Level n holds the timers due further out, one slot per 64^n ticks. Each time the level below wraps
+ *   around, the next slot of level n is emptied and its timers are put back in, which places each one
+ *   a level lower, until it reaches level 0.
+ * A timer is moved at most TIMER_WHEEL_LEVELS - 1 times in all, so a tick only ever touches the slots that are
+ * due. Callbacks run from the tick the same way setTimeout callbacks do, inside the timer interrupt, so they
+ * should only change state for the main loop to act on. A callback may start its own timer again.
+ *
+ * The hardware timer doesn't interrupt on every tick. While any timer is running it is set to go off on the
+ * next tick that has something to do, a due slot or a level wrapping around, but no more than
+ * TIMER_WHEEL_IDLE_TICKS away, and the wheel catches up all the ticks in between at once. That keeps the
+ * processor dozing (see CSidle.c) for up to a second at a time. How far into the hardware timer's interval
+ * the processor is can't be read back, so a timer started meanwhile is counted from the end of the interval:
+ * it never goes off early, and at most TIMER_WHEEL_IDLE_TICKS late.
+ *
+ * Anything that still calls setTimeout directly takes the hardware timer away from the wheel. The wheel leaves
+ * it alone until that timeout has gone off and its callback has set csState.timerMode back to OFF, as every
+ * setTimeout callback does. timerWheelCheck looks once a second, and timerWheelStart each time it is called,
+ * and sets the timer again once timerMode is OFF while the wheel thinks the timer is set. The part of the lost
+ * interval that had passed can't be known, so the running timers go off that much late.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CStimers.h"
+#include "CStimerWheel.h"
+
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK  (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_MAX   ((1ul << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)) - 1) //longest timeout in ticks
+
+static timer_wheel_t* wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint32_t wheelNext;    //tick the next slot of level 0 is for
+static uint16_t wheelRunning; //timers in the wheel
+static uint8_t wheelArmed;    //ticks the hardware timer is set for, 0 while it isn't
+static BOOL wheelInTick;      //the wheel is catching up, the hardware timer is set again after
+
+static void timerWheelHardwareTick();
+
+/*
+ * timerWheelArm
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sets the hardware timer for the next tick that has something to do, if any timer is running.
+ *       Must be called with interrupts disabled or from the timer interrupt.
+ */
+static void timerWheelArm(){
+    uint8_t ticks;
+    if(wheelRunning == 0){
+        return;
+    }
+    for(ticks = 1; ticks < TIMER_WHEEL_IDLE_TICKS; ticks++){
+        uint8_t index = (wheelNext + ticks - 1) & TIMER_WHEEL_MASK;
+        if((index == 0) || (wheel[0][index] != NULL)){
+            break; //a level wraps around or timers are due
+        }
+    }
+    wheelArmed = ticks;
+    setTimeout((uint32_t)ticks * TIMER_WHEEL_TICK_MS, &timerWheelHardwareTick, STATUS_MONITOR);
+}
+
+/*
+ * timerWheelLost
+ * INPUT: none
+ * OUTPUT: BOOL - true if the hardware timer was set for the wheel and something else has taken it and is done
+ * INFO: Must be called with interrupts disabled.
+ */
+static BOOL timerWheelLost(){
+    return (wheelArmed != 0) && !wheelInTick && (Global->csState.timerMode == OFF);
+}
+
+/*
+ * timerWheelLink
+ * INPUT: timer_wheel_t* timer - timer with its expiry set, not in the wheel
+ * OUTPUT: none
+ * INFO: Puts the timer in the slot of the lowest level that reaches as far as its expiry.
+ *       Must be called with interrupts disabled.
+ */
+static void timerWheelLink(timer_wheel_t* timer){
+    uint32_t delta = timer->expires - wheelNext;
+    timer_wheel_t** slot;
+    uint8_t level;
+    if(delta > TIMER_WHEEL_MAX){
+        slot = &wheel[0][wheelNext & TIMER_WHEEL_MASK]; //already due, the wrap around of a past expiry
+    }
+    else{
+        for(level = 0; (level < TIMER_WHEEL_LEVELS - 1) && (delta >> ((level + 1) * TIMER_WHEEL_BITS)); level++){
+        }
+        slot = &wheel[level][(timer->expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK];
+    }
+    timer->next = *slot;
+    if(timer->next != NULL){
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = slot;
+    *slot = timer;
+}
+
+/*
+ * timerWheelUnlink
+ * INPUT: timer_wheel_t* timer - timer in the wheel
+ * OUTPUT: none
+ * INFO: Must be called with interrupts disabled.
+ */
+static void timerWheelUnlink(timer_wheel_t* timer){
+    *timer->pprev = timer->next;
+    if(timer->next != NULL){
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/*
+ * timerWheelStart
+ * INPUT: timer_wheel_t* timer - the caller's timer, restarted if it is already running
+ *        uint32_t ms - how long from now it goes off, rounded up to a whole tick
+ *        CallbackFunction callback - called from the timer interrupt when it does
+ * OUTPUT: none
+ * INFO: Safe to call from the main loop or from a timer callback. Starts the hardware timer if this is the
+ *       only timer running or the wheel has lost it.
+ */
+void timerWheelStart(timer_wheel_t* timer, uint32_t ms, CallbackFunction callback){
+    uint32_t ticks = (ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    if(timerWheelLost()){
+        wheelArmed = 0; //counted from now instead, and the hardware timer is set again below
+    }
+    if(timer->pprev != NULL){
+        timerWheelUnlink(timer);
+        wheelRunning--;
+    }
+    if(ticks == 0){
+        ticks = 1;
+    }
+    else if(ticks > TIMER_WHEEL_MAX - TIMER_WHEEL_IDLE_TICKS){
+        ticks = TIMER_WHEEL_MAX - TIMER_WHEEL_IDLE_TICKS; //room for the rest of the hardware timer's interval
+    }
+    timer->expires = wheelNext + wheelArmed + ticks - 1; //wheelNext is one tick away
+    timer->callback = callback;
+    timerWheelLink(timer);
+    wheelRunning++;
+    if((wheelArmed == 0) && !wheelInTick){
+        timerWheelArm();
+    }
+    Metal_SetCPUPriority(priority);
+}
+
+/*
+ * timerWheelCancel
+ * INPUT: timer_wheel_t* timer - the caller's timer
+ * OUTPUT: none
+ * INFO: Nothing happens if it isn't running. The hardware timer stops the next time it goes off once nothing
+ *       is running.
+ */
+void timerWheelCancel(timer_wheel_t* timer){
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    if(timer->pprev != NULL){
+        timerWheelUnlink(timer);
+        wheelRunning--;
+    }
+    Metal_SetCPUPriority(priority);
+}
+
+/*
+ * timerWheelCheck
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Sets the hardware timer again if something else took it from the wheel and is done with it, otherwise
+ *       the wheel would wait for it forever. Called once a second from the main loop, see eventTelemetry in CSevents.c.
+ */
+void timerWheelCheck(){
+    cpu_priority_t priority = Metal_SetCPUPriority(UNINTERRUPTIBLE_PRIORITY);
+    if(timerWheelLost()){
+        wheelArmed = 0;
+        timerWheelArm();
+    }
+    Metal_SetCPUPriority(priority);
+}
+
+/*
+ * timerWheelPending
+ * INPUT: timer_wheel_t const* timer - the caller's timer
+ * OUTPUT: BOOL - true if it is running and hasn't gone off yet
+ */
+BOOL timerWheelPending(timer_wheel_t const* timer){
+    return timer->pprev != NULL;
+}
+
+/*
+ * timerWheelCascade
+ * INPUT: uint8_t level - level above 0 to take the next slot of
+ * OUTPUT: uint8_t - the slot taken, 0 when this level wrapped around as well
+ * INFO: Puts every timer of the slot back in the wheel, which moves each one down at least a level.
+ */
+static uint8_t timerWheelCascade(uint8_t level){
+    uint8_t index = (wheelNext >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+    timer_wheel_t* timer = wheel[level][index];
+    wheel[level][index] = NULL;
+    while(timer != NULL){
+        timer_wheel_t* next = timer->next;
+        timerWheelLink(timer);
+        timer = next;
+    }
+    return index;
+}
+
+/*
+ * timerWheelTick
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Called from the timer interrupt for each TIMER_WHEEL_TICK_MS that passed. Brings down the timers of the
+ *       higher levels that are now within reach, then calls back each timer due on this tick.
+ */
+static void timerWheelTick(){
+    uint8_t index = wheelNext & TIMER_WHEEL_MASK;
+    uint8_t level;
+    timer_wheel_t* timer;
+    if(index == 0){
+        for(level = 1; (level < TIMER_WHEEL_LEVELS) && (timerWheelCascade(level) == 0); level++){
+        }
+    }
+    wheelNext++;
+    //callbacks may start timers, which go in later slots
+    while((timer = wheel[0][index]) != NULL){
+        timerWheelUnlink(timer);
+        wheelRunning--;
+        timer->callback();
+    }
+}
+
+/*
+ * timerWheelHardwareTick
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: setTimeout callback. Runs the wheel for every tick the hardware timer was set for, only the last of
+ *       which can have anything due, then sets it again while any timer is running.
+ */
+static void timerWheelHardwareTick(){
+    uint8_t ticks = wheelArmed;
+    G_SET(csState.timerMode, NULL);
+    wheelArmed = 0;
+    wheelInTick = true;
+    while(ticks-- > 0){
+        timerWheelTick();
+    }
+    wheelInTick = false;
+    timerWheelArm();
+}
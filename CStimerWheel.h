@@ -0,0 +1,36 @@
+/*
+ * File:   CStimerWheel.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Any number of software timers run off the one hardware timer of CStimers, see CStimerWheel.c
+ */
+
+#ifndef CSTIMERWHEEL_H
+#define	CSTIMERWHEEL_H
+
+#include <stdint.h>
+#include "types.h"
+#include "CStimers.h"
+
+#define TIMER_WHEEL_TICK_MS 100 //resolution of every software timer
+#define TIMER_WHEEL_BITS    6   //each level of the wheel has 1 << TIMER_WHEEL_BITS slots
+#define TIMER_WHEEL_LEVELS  4   //level n slots are 1 << (n * TIMER_WHEEL_BITS) ticks apart, ~19 days in all
+#define TIMER_WHEEL_IDLE_TICKS 10 //longest the hardware timer is set for, and so the most a timer can be late
+
+//a timer is owned by whoever uses it and only linked into the wheel while it is running
+typedef struct timer_wheel_s{
+    struct timer_wheel_s*  next;
+    struct timer_wheel_s** pprev;   //whatever points at this timer, NULL while it isn't running
+    uint32_t               expires; //tick it is due on
+    CallbackFunction       callback;
+} timer_wheel_t;
+
+void timerWheelStart(timer_wheel_t* timer, uint32_t ms, CallbackFunction callback);
+void timerWheelCancel(timer_wheel_t* timer);
+void timerWheelCheck();
+BOOL timerWheelPending(timer_wheel_t const* timer);
+
+#endif	/* CSTIMERWHEEL_H */
+
@@ -22,10 +22,14 @@
 #include "types.h"
 #include "CSlinearBuf.h"
 #include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
 #include "CSlink.h"
 #include "CStimers.h"
 #include "CScubesat.h"
 #include "CSresponsePoll.h"
+#include "CSbeacon.h"
+#include "CScondition.h"
+#include "CSderived.h"
 
 // Mark an argument as unused.
 #define UNUSED __attribute__((unused))
@@ -34,7 +38,7 @@
  * These enumerated types defines the possible states and substates the CubeSat can be in.
  */
 typedef enum {RESET_STATE=1, STARTUP, SAFE_HOLD, COMMAND_RESPONSE, STATUS_MONITORING, ANOMALY } MainState;
-typedef enum {DIAGNOSTIC_CHECK=1, ALL_QUIET, BEACON_ON, PENDING_PROCESS} StatMonState;
+typedef enum {DIAGNOSTIC_CHECK=1, ALL_QUIET, BEACON_ON} StatMonState;
 
 
 /*type definition of structures*/
@@ -55,10 +59,14 @@ typedef struct {
     uint16 anomalyModeBasicInfo[5];
     uint8 anomalyslot;
     uint8 battSlot;
+    uint32 diagTime;        //when the last daily diagnostic finished, see CSdiagnostic.c
+    uint16 diagConfigCheck; //its check of the uploaded configuration
+    uint8 diagResult;       //its DIAG_FAIL_ and DIAG_CONFIG_CHANGED bits
 }csBasicTelemetryX;
 
 typedef struct{
     uint16 reading[44];
+    uint32 epoch;        //csunSatEpoch time the readings were taken
 }csLastTelemetryX;
 
 // represents time since last fault and flag indicating whether we can return to
@@ -77,7 +85,13 @@ typedef struct {
 
     csLastTelemetryX csLastTelemetry;
 
-    sequence_t csSequence;
+    sequence_t csSequence[NUM_SEQUENCES]; //each one runs independently, see pendingProcess
+
+    uint8_t csSequenceUpload;             //slot the ground's sequence commands are loaded into, see sequenceUploadSlot
+
+    cond_program_t csCondProgram; //condition programs the sequence's conditions can refer to, see CScondition.c
+
+    derived_config_t csDerived[DERIVED_SIGNALS]; //derived signals conditions can compare, see CSderived.c
 
     response_poll_t csResponsePoll;
 
@@ -168,7 +182,8 @@ typedef struct {
 
     struct {
         bool beacon_enabled;          //Defines if the beacon is enabled when the radio link is not enabled
-        char beaconMsg[31];
+        char beaconMsg[BEACON_MSG_LENGTH];
+        beacon_slot_t layout[BEACON_MSG_LENGTH]; //where each beacon character comes from, see beaconLayoutLoad
     } csBeacon;
 
     struct {
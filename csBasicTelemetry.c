@@ -12,6 +12,7 @@
 #include "debug.h"
 #include "CSlinearBuf.h"
 #include "CSdefine.h"
+#include "csBasicTelemetry.h"
 
 
 /**
@@ -51,6 +52,10 @@ uint16 checkInitBasicTelemetry(){
     chk |= Global->csBasicTelemetry.battDeltaTemp;
     chk |= Global->csBasicTelemetry.battSlot;
 
+    //check the last diagnostic's results
+    chk |= Global->csBasicTelemetry.diagTime;
+    chk |= Global->csBasicTelemetry.diagConfigCheck;
+    chk |= Global->csBasicTelemetry.diagResult;
 
     return chk;
 }
@@ -197,16 +202,38 @@ void storeAnomalyBasicTelemetry(uint16 anomalyInfo, uint32 time){
     G_SET(csBasicTelemetry.anomalyslot, &slot);
 }
 
+/*
+ * storeDiagBasicTelemetry
+ * INPUT: uint8 result - DIAG_FAIL_ and DIAG_CONFIG_CHANGED bits, see CSdiagnostic.h
+ *        uint16 configCheck - check of the uploaded configuration
+ *        uint32 time - time that the diagnostic finished
+ * OUTPUT: none
+ * INFO: The results of the last daily diagnostic are kept with the basic telemetry so the ground sees them in
+ * the same pass. Each failed check also took an anomaly slot with the details.
+ */
+void storeDiagBasicTelemetry(uint8 result, uint16 configCheck, uint32 time){
+    G_SET(csBasicTelemetry.diagResult, &result);
+    G_SET(csBasicTelemetry.diagConfigCheck, &configCheck);
+    G_SET(csBasicTelemetry.diagTime, &time);
+}
+
 
 /*
  * getBasicTelemetry
  * INPUT: char* telem - pointer to the array that will house the data to be sent to the ground
- * OUTPUT: NONE (technically char * telem)
+ *        uint16_t size - bytes the array holds, at least BASIC_TELEMETRY_BYTES
+ * OUTPUT: uint16_t - bytes packed, 0 if the array is too small and nothing was written
  * INFO: all of the basic telemetry is packed up and sent to the ground. Nested loops are used in order to keep the code
  * slightly more condensed and in case the size of the time values were adjusted more in the future.
+ * The first byte is BASIC_TELEMETRY_VERSION, everything else follows it.
  */
-uint16_t getBasicTelemetry(char * telem){
+uint16_t getBasicTelemetry(char * telem, uint16_t size){
     uint8 i,j;
+    if(size < BASIC_TELEMETRY_BYTES){
+        return 0;
+    }
+    telem[0] = BASIC_TELEMETRY_VERSION;
+    telem++; //offsets below are from after the version
     //first loop to input each sensor's information
     /*Because each sensor has 17 bytes associated with it, the first value of each sensor
      , the sensor number, needs to be offset to every 17th byte (which is the reason for i*17 */
@@ -244,6 +271,13 @@ uint16_t getBasicTelemetry(char * telem){
             telem[((NUM_SENSORS*SENSOR_BYTES)+ 3 + (i*6) + 2 + j)] = (Global->csBasicTelemetry.anomalyModeTime[i] >> (24-(8*j)));
         }
     }
-    uint16_t retVal = ((NUM_SENSORS*SENSOR_BYTES)+3+(5*6));
+    //the last diagnostic's result, configuration check and time
+    telem[((NUM_SENSORS*SENSOR_BYTES)+ 3 + (5*6))] = Global->csBasicTelemetry.diagResult;
+    telem[((NUM_SENSORS*SENSOR_BYTES)+ 3 + (5*6) + 1)] = (Global->csBasicTelemetry.diagConfigCheck >> 8);
+    telem[((NUM_SENSORS*SENSOR_BYTES)+ 3 + (5*6) + 2)] = Global->csBasicTelemetry.diagConfigCheck;
+    for(j=0;j<4;j++){
+        telem[((NUM_SENSORS*SENSOR_BYTES)+ 3 + (5*6) + 3 + j)] = (Global->csBasicTelemetry.diagTime >> (24-(8*j)));
+    }
+    uint16_t retVal = BASIC_TELEMETRY_BYTES;
     return retVal;
 }
\ No newline at end of file
@@ -11,13 +11,20 @@
 //define statement to also declare clearBasicTelem as basicTelemInit
 #define clearBasicTelemetry     initBasicTelemetry
 
+//layout of what getBasicTelemetry packs, sent first so the ground knows how to read the rest. Version 2 added
+//the diagnostic results at the end.
+#define BASIC_TELEMETRY_VERSION 2
+//bytes getBasicTelemetry packs: version, sensors, battery delta and state, 5 anomalies, diagnostic
+#define BASIC_TELEMETRY_BYTES   (1 + (NUM_SENSORS*SENSOR_BYTES) + 3 + (5*6) + 7)
+
 uint16 checkInitBasicTelemetry();
 void storeBattDelta(uint16 battery);
 uint16 initBasicTelemetry();
 uint16 clearBasicTelemetry();
 void storeBasicTelemetry(telemetry_block_t values);
 void storeAnomalyBasicTelemetry(uint16 anomalyInfo, uint32 time);
-uint16_t getBasicTelemetry(char * telem);
+void storeDiagBasicTelemetry(uint8 result, uint16 configCheck, uint32 time);
+uint16_t getBasicTelemetry(char * telem, uint16_t size);
 
 #endif	/* CSBASICTELEMETRY_H */
 
@@ -0,0 +1,182 @@
+/*
+ * File:   beaconCheck.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Ground check that the table driven beacon encoding in CSbeacon.c gives exactly the characters the original
+ * intToBeaconChar, getTempChar and beaconMsgUpdateTelemetry gave. The originals are kept below as they were,
+ * apart from writing into a plain buffer and leaving out the debug print. Every 16 bit input is tried:
+ *   - intToBeaconChar of every value
+ *   - getTempChar of every count
+ *   - beaconMsgUpdateTelemetry with the default layout for every count, each reading offset by its index so
+ *     a character built from the wrong reading shows up
+ * Prints the first mismatch of each and exits non-zero if there was any.
+ *
+ * usage: beaconCheck
+ *
+ * Build from this directory with the flight include paths and the host compiler, for instance:
+ *   gcc -I. -I.. <flight include dirs> -o beaconCheck beaconCheck.c ../CSbeacon.c
+ * It doesn't use hostMocks.c, which stands in for the beacon itself.
+ */
+
+#define dprintf stdioDprintf //the host's dprintf writes to a file descriptor, the flight one is defined below
+#include <stdio.h>
+#undef dprintf
+#include "types.h"
+#include "Globals.h"
+#include "debug.h"
+#include "CSbeacon.h"
+
+#define NUM_READINGS (sizeof(Global->csLastTelemetry.reading) / sizeof(Global->csLastTelemetry.reading[0]))
+
+static GlobalX hostGlobal;
+GlobalX* const Global = &hostGlobal;
+
+BOOL globalMod(size_t offset, void const* src, size_t size){
+    if(src == NULL){
+        memset((uint8_t*)Global + offset, 0, size);
+    }
+    else{
+        memcpy((uint8_t*)Global + offset, src, size);
+    }
+    return true;
+}
+
+int dprintf(const char* format, ...){
+    return 0;
+}
+
+static char oldMsg[BEACON_MSG_LENGTH];
+
+/*
+ * oldIntToBeaconChar
+ * INFO: intToBeaconChar before the lookup table.
+ */
+static char oldIntToBeaconChar(uint16_t val){
+    if(val >= 34){
+        return 'A';
+    }
+    char ret;
+    if(val < 24){ //0-23
+        ret = val + 65;
+        if(ret >= 'S'){ //skipping E and T
+            ret += 2;
+        }
+        else if(ret >= 'E'){ //just skipping E
+            ret++;
+        }
+    }
+    else{ // val >= 24 && val <34
+        ret = val + 24; //'0' == 48
+    }
+    return ret;
+}
+
+/*
+ * oldGetTempChar
+ * INFO: getTempChar before the lookup table.
+ */
+static uint8_t oldGetTempChar(uint8_t index){
+    char tempChar;
+    //get value and adjust it down by 1385
+    int16_t temp = (Global->csLastTelemetry.reading[index] - 1385);
+    //negative counts are all too low, set to the min
+    if(temp <= 0){
+        tempChar = oldIntToBeaconChar(0);
+    }
+    //everything else needs step 2
+    else{
+        //only care about 7 most significant bits
+        temp = (temp >> 5);
+        //over range goes to max char
+        if (temp >= 33){
+            tempChar = oldIntToBeaconChar(33);
+        }
+        //otherwise get the appropriate character
+        else{
+            tempChar = oldIntToBeaconChar(temp);
+        }
+    }
+    return tempChar;
+}
+
+/*
+ * oldMsgUpdateTelemetry
+ * INFO: beaconMsgUpdateTelemetry before the layout table, into oldMsg.
+ */
+static void oldMsgUpdateTelemetry(){
+    oldMsg[SC_BATT_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[19]) >> 7));
+    oldMsg[SC_BATT_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[20]) >> 7));
+    oldMsg[SC_BATT_T] = oldGetTempChar(21);
+    oldMsg[PL_BATT_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[26]) >> 7));
+    oldMsg[PL_BATT_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[27]) >> 7));
+    oldMsg[PL_BATT_T] = oldGetTempChar(28);
+    oldMsg[V3d3_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[16]) >> 7));
+    oldMsg[V3d3_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[15]) >> 7));
+    oldMsg[V3d3_SW1_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[43]) >> 7));
+    oldMsg[V3d3_SW1_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[42]) >> 7));
+    oldMsg[V3d3_SW2_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[41]) >> 7));
+    oldMsg[V3d3_SW2_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[40]) >> 7));
+    oldMsg[V3d3_SW3_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[39]) >> 7));
+    oldMsg[V3d3_SW3_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[38]) >> 7));
+    oldMsg[V3d3_SW4_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[18]) >> 7));
+    oldMsg[V3d3_SW4_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[17]) >> 7));
+    oldMsg[V5_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[12]) >> 7));
+    oldMsg[V5_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[11]) >> 7));
+    oldMsg[V5_SW5_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[14]) >> 7));
+    oldMsg[V5_SW5_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[13]) >> 7));
+    oldMsg[V12_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[8]) >> 7));
+    oldMsg[V12_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[7]) >> 7));
+    oldMsg[V12_SW6_V] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[10]) >> 7));
+    oldMsg[V12_SW6_A] = oldIntToBeaconChar(((Global->csLastTelemetry.reading[9]) >> 7));
+    oldMsg[RADIO_T] = oldGetTempChar(24);
+}
+
+int main(int argc, char** argv){
+    uint32_t v;
+    uint32_t bad = 0;
+    uint32_t total = 0;
+    uint8_t i;
+
+    for(v = 0; v <= 0xFFFF; v++){
+        if(intToBeaconChar(v) != oldIntToBeaconChar(v)){
+            if(bad++ == 0){
+                printf("intToBeaconChar(%lu): %c, was %c\n", (unsigned long)v, intToBeaconChar(v), oldIntToBeaconChar(v));
+            }
+        }
+    }
+    printf("intToBeaconChar: %lu mismatches\n", (unsigned long)bad);
+
+    total += bad;
+    bad = 0;
+    for(v = 0; v <= 0xFFFF; v++){
+        Global->csLastTelemetry.reading[21] = v;
+        if(getTempChar(21) != oldGetTempChar(21)){
+            if(bad++ == 0){
+                printf("getTempChar of %lu: %c, was %c\n", (unsigned long)v, getTempChar(21), oldGetTempChar(21));
+            }
+        }
+    }
+    printf("getTempChar: %lu mismatches\n", (unsigned long)bad);
+
+    total += bad;
+    bad = 0;
+    beaconMsgInit();
+    memcpy(oldMsg, Global->csBeacon.beaconMsg, BEACON_MSG_LENGTH);
+    for(v = 0; v <= 0xFFFF; v++){
+        for(i = 0; i < NUM_READINGS; i++){
+            Global->csLastTelemetry.reading[i] = v + ((uint16_t)i << 5);
+        }
+        beaconMsgUpdateTelemetry();
+        oldMsgUpdateTelemetry();
+        if(memcmp(Global->csBeacon.beaconMsg, oldMsg, BEACON_MSG_LENGTH) != 0){
+            if(bad++ == 0){
+                printf("beacon for %lu: %.31s, was %.31s\n", (unsigned long)v, Global->csBeacon.beaconMsg, oldMsg);
+            }
+        }
+    }
+    printf("beaconMsgUpdateTelemetry: %lu mismatches\n", (unsigned long)bad);
+    total += bad;
+    return (total == 0) ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/*
+ * File:   condBench.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Ground benchmark of the condition program evaluator (CScondition.c) against the JUST/AND/OR switch that
+ * pendingProcess used for exit and wait conditions before condition programs. Each condition is evaluated the
+ * given number of times both ways against readings that change every time, best of BENCH_ROUNDS, and the
+ * results are compared beforehand so the two are known to agree. The switch is kept below as it was, calling
+ * the flight checkCond.
+ *
+ * The envelope case, six readings that all have to stay in range, can't be written as one conditions_t, so
+ * it is only timed as a program.
+ *
+ * usage: condBench [iterations]
+ *   iterations defaults to 10000000
+ *
+ * Build from this directory like seqReplay.c, replacing seqReplay.c with condBench.c. Times are for the host,
+ * so only the ratio between the two says anything about the satellite. On the host the two come out about even
+ * for one or two comparisons; what a program adds is that it isn't limited to two.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "types.h"
+#include "Globals.h"
+#include "CSlogging.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+#include "CScondition.h"
+#include "hostMocks.h"
+
+#define BENCH_NOW    1000000u
+#define BENCH_ROUNDS 5 //each loop is timed this many times and the fastest kept
+
+//readings the benchmark conditions compare
+static const uint8_t BENCH_SENSORS[] = {3, 9, 20, 21, 22, 23, 24, 25};
+
+void hostEvent(char const* what, uint32_t a, uint32_t b){
+}
+
+void setTimeout(uint32_t ms, CallbackFunction callback, TimerMode mode){
+}
+
+/*
+ * oldConditions
+ * INFO: The exit condition switch from pendingProcess before condition programs, status codes and all.
+ */
+static BOOL oldConditions(conditions_t exitCheck, uint8_t* status){
+    BOOL result = false;
+    switch(exitCheck.op){
+        case JUST:
+            result = checkCond(exitCheck.left, BENCH_NOW, 0);
+            *status = 1;
+            break;
+        case AND:
+            result = (checkCond(exitCheck.left, BENCH_NOW, 0) && checkCond(exitCheck.right, BENCH_NOW, 0));
+            *status = 2;
+            break;
+        case OR:
+            result = checkCond(exitCheck.left, BENCH_NOW, 0);
+            if(result){
+                *status = 3;
+            }
+            result = result || checkCond(exitCheck.right, BENCH_NOW, 0);
+            if(result && *status != 3){
+                *status = 4;
+            }
+            else if(result){
+                *status = 5;
+            }
+            break;
+    }
+    return result;
+}
+
+/*
+ * benchLeaf
+ * INPUT: uint8_t* code - where the COND_LEAF instruction goes
+ *        uint8_t tag, sensor, comparator - fields of the leaf
+ *        uint32_t value - value it compares to
+ * OUTPUT: uint8_t - bytes written
+ */
+static uint8_t benchLeaf(uint8_t* code, uint8_t tag, uint8_t sensor, uint8_t comparator, uint32_t value){
+    code[0] = COND_LEAF;
+    code[1] = tag;
+    code[2] = sensor;
+    code[3] = comparator;
+    code[4] = value >> 24;
+    code[5] = value >> 16;
+    code[6] = value >> 8;
+    code[7] = value;
+    return COND_LEAF_BYTES;
+}
+
+/*
+ * benchReadings
+ * INPUT: uint32_t n - iteration
+ * OUTPUT: none
+ * INFO: Moves the compared readings on so consecutive evaluations don't all give the same answer.
+ */
+static void benchReadings(uint32_t n){
+    uint8_t i;
+    for(i = 0; i < sizeof(BENCH_SENSORS); i++){
+        Global->csLastTelemetry.reading[BENCH_SENSORS[i]] = (uint16_t)((n * 7 + i * 131) & 0x0FFF);
+    }
+}
+
+/*
+ * benchSeconds
+ * INPUT: struct timespec const* start - when timing started
+ * OUTPUT: double - seconds since then
+ */
+static double benchSeconds(struct timespec const* start){
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv){
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : 10000000u;
+    uint8_t code[COND_PROGRAM_SIZE];
+    uint16_t len = 0;
+    uint16_t start[4];
+    uint16_t jump[5];
+    conditions_t cond[3];
+    char const* name[4] = {"JUST", "AND", "OR", "envelope"};
+    uint32_t mismatches = 0;
+    uint8_t c;
+    uint8_t i;
+
+    //sensor 3 > 2000
+    memset(cond, 0, sizeof(cond));
+    cond[0].op = JUST;
+    cond[0].left.sensor_id = 3;
+    cond[0].left.comparator = GREATER;
+    cond[0].left.value = 2000;
+    start[0] = len;
+    len += benchLeaf(&code[len], 0, 3, GREATER, 2000);
+    code[len++] = COND_END;
+
+    //sensor 3 > 2000 AND sensor 9 <= 3000
+    cond[1] = cond[0];
+    cond[1].op = AND;
+    cond[1].right.sensor_id = 9;
+    cond[1].right.comparator = LESS_EQ;
+    cond[1].right.value = 3000;
+    start[1] = len;
+    len += benchLeaf(&code[len], 1, 3, GREATER, 2000);
+    code[len++] = COND_JUMP_FALSE;
+    code[len++] = COND_LEAF_BYTES + 1;
+    len += benchLeaf(&code[len], 2, 9, LESS_EQ, 3000);
+    code[len++] = COND_AND;
+    code[len++] = COND_END;
+
+    //sensor 3 > 2000 OR sensor 9 <= 3000
+    cond[2] = cond[1];
+    cond[2].op = OR;
+    start[2] = len;
+    len += benchLeaf(&code[len], 3, 3, GREATER, 2000);
+    code[len++] = COND_JUMP_TRUE;
+    code[len++] = COND_LEAF_BYTES + 1;
+    len += benchLeaf(&code[len], 4, 9, LESS_EQ, 3000);
+    code[len++] = COND_OR;
+    code[len++] = COND_END;
+
+    //six readings all in range, as an exit condition: NOT(all in range). Once one is out of range the rest
+    //don't matter, so each AND so far jumps straight to the NOT if it's false.
+    start[3] = len;
+    for(i = 0; i < 6; i++){
+        len += benchLeaf(&code[len], 10 + i, 20 + i, LESS, 3900);
+        if(i > 0){
+            code[len++] = COND_AND;
+        }
+        if(i < 5){
+            jump[i] = len;
+            code[len++] = COND_JUMP_FALSE;
+            code[len++] = 0;
+        }
+    }
+    for(i = 0; i < 5; i++){
+        code[jump[i] + 1] = len - (jump[i] + COND_JUMP_BYTES);
+    }
+    code[len++] = COND_NOT;
+    code[len++] = COND_END;
+
+    if(condProgramLoad(code, len) != 0){
+        printf("benchmark programs didn't load\n");
+        return 1;
+    }
+
+    for(c = 0; c < 3; c++){
+        uint32_t n;
+        for(n = 0; n < 100000; n++){
+            uint8_t oldStatus, newStatus;
+            benchReadings(n);
+            if(oldConditions(cond[c], &oldStatus) != condProgramEval(start[c], BENCH_NOW, &newStatus)){
+                if(mismatches++ == 0){
+                    printf("%s gives a different result at iteration %lu\n", name[c], (unsigned long)n);
+                }
+            }
+        }
+    }
+
+    for(c = 0; c < 4; c++){
+        struct timespec t;
+        uint32_t n;
+        uint32_t trues = 0;
+        double base = 1e9;
+        double oldTime = 1e9;
+        double newTime = 1e9;
+        double took;
+        uint8_t status;
+        uint8_t round;
+        for(round = 0; round < BENCH_ROUNDS; round++){
+            //the readings change in every loop, time that on its own to take it out
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            for(n = 0; n < iterations; n++){
+                benchReadings(n);
+                __asm__ volatile("" ::: "memory");
+            }
+            took = benchSeconds(&t);
+            base = (took < base) ? took : base;
+            if(c < 3){
+                clock_gettime(CLOCK_MONOTONIC, &t);
+                for(n = 0; n < iterations; n++){
+                    benchReadings(n);
+                    trues += oldConditions(cond[c], &status);
+                }
+                took = benchSeconds(&t);
+                oldTime = (took < oldTime) ? took : oldTime;
+            }
+            trues = 0;
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            for(n = 0; n < iterations; n++){
+                benchReadings(n);
+                trues += condProgramEval(start[c], BENCH_NOW, &status);
+            }
+            took = benchSeconds(&t);
+            newTime = (took < newTime) ? took : newTime;
+        }
+        oldTime -= base;
+        newTime -= base;
+        if(c < 3){
+            printf("%-8s switch %6.1f ns, program %6.1f ns, %.2fx\n", name[c],
+                   oldTime * 1e9 / iterations, newTime * 1e9 / iterations, oldTime / newTime);
+        }
+        else{
+            printf("%-8s program %6.1f ns, true %lu of %lu\n", name[c], newTime * 1e9 / iterations,
+                   (unsigned long)trues, (unsigned long)iterations);
+        }
+    }
+    return (mismatches == 0) ? 0 : 1;
+}
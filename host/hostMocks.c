@@ -0,0 +1,146 @@
+/*
+ * File:   hostMocks.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Host versions of everything outside the pending command code that it calls. The globals are a single plain
+ * copy instead of being triple redundant, the RTC reads the replay's simulated time, and commands that would
+ * drive hardware only report what they would have done through hostEvent. There is no SD card: no file can be
+ * opened, so the poll log never writes, and SD jobs succeed straight away.
+ */
+
+#include "types.h"
+#include "Globals.h"
+#include "metal/cpu.h"
+#include "CSi2c.h"
+#include "CSjournal.h"
+#include "csRadio.h"
+#include "csSDCard.h"
+#include "CSswitchCommands.h"
+#include "CSopenSourceFAT.h"
+#include "CSbeacon.h"
+#include "hostMocks.h"
+
+static GlobalX hostGlobal;
+GlobalX* const Global = &hostGlobal;
+
+uint32_t hostTime;
+
+static cpu_priority_t hostPriority;
+static journal_t hostJournal;
+
+/*
+ * globalMod
+ * INPUT: size_t offset - offset of the field in GlobalX
+ *        void const* src - new value, NULL to zero the field
+ *        size_t size - bytes to write
+ * OUTPUT: BOOL - always true, there is only one copy to write
+ */
+BOOL globalMod(size_t offset, void const* src, size_t size){
+    if(src == NULL){
+        memset((uint8_t*)Global + offset, 0, size);
+    }
+    else{
+        memcpy((uint8_t*)Global + offset, src, size);
+    }
+    return true;
+}
+
+void SettleGlobal(){
+}
+
+cpu_priority_t Metal_SetCPUPriority(cpu_priority_t priority){
+    cpu_priority_t old = hostPriority;
+    hostPriority = priority;
+    return old;
+}
+
+INT64 getRTC(){
+    return hostTime;
+}
+
+uint32_t csunSatEpoch(INT64 time){
+    return (uint32_t)time;
+}
+
+void Journal_GetStruct(journal_t* journal){
+    *journal = hostJournal;
+}
+
+void Journal_SetStruct(journal_t* journal){
+    hostJournal = *journal;
+}
+
+void radioConfig(radio_config_t* config){
+    hostEvent("radio config", 0, 0);
+}
+
+void setPCASwitch(uint8_t pca, uint8_t config){
+    hostEvent("set switch", pca, config);
+}
+
+void setProcMode(uint8_t mode){
+    hostEvent("processor mode", mode, 0);
+}
+
+void resetPayload(){
+    hostEvent("reset payload", 0, 0);
+}
+
+void beaconMsgUpdateSingle(beacon_msg_index_t index, char val){
+    hostEvent("beacon", index, (uint8_t)val);
+}
+
+void flushTelemetryToSD(){
+}
+
+void checkSDCard(){
+    hostEvent("check SD", 0, 0);
+}
+
+int Storage_Init(){
+    return 1;
+}
+
+int FSformat(char mode, long serial, char* volume){
+    hostEvent("format SD", mode, 0);
+    return 0;
+}
+
+int FSerror(){
+    return 0;
+}
+
+FSFILE* FSfopen(const char* name, const char* mode){
+    return NULL;
+}
+
+int FSfclose(FSFILE* file){
+    return 0;
+}
+
+size_t FSfread(void* data, size_t size, size_t n, FSFILE* file){
+    return 0;
+}
+
+size_t FSfwrite(const void* data, size_t size, size_t n, FSFILE* file){
+    return 0;
+}
+
+int FSfseek(FSFILE* file, long offset, int whence){
+    return -1;
+}
+
+long FSftell(FSFILE* file){
+    return -1;
+}
+
+int FSremove(const char* name){
+    return 0;
+}
+
+//the satellite's debug output is dropped, only the timeline is printed
+int dprintf(const char* format, ...){
+    return 0;
+}
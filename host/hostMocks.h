@@ -0,0 +1,23 @@
+/*
+ * File:   hostMocks.h
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Stand-ins for the hardware and metal functions the pending command code calls, so it can run on a ground
+ * computer. See seqReplay.c.
+ */
+
+#ifndef HOSTMOCKS_H
+#define	HOSTMOCKS_H
+
+#include <stdint.h>
+
+//set by the replay before each second, the mocked RTC reads it back
+extern uint32_t hostTime;
+
+//called by the mocked command handlers, printed on the replay timeline (see seqReplay.c)
+void hostEvent(char const* what, uint32_t a, uint32_t b);
+
+#endif	/* HOSTMOCKS_H */
+
@@ -0,0 +1,156 @@
+/*
+ * File:   idleSim.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Ground tool that runs the status monitoring state machine against a simulated clock to see how much of the
+ * time the processor spends dozing (see CSidle.c). The main loop is modelled as calling
+ * statusMonitoringStateMachine over and over, each pass taking the given time awake. The telemetry interrupt
+ * comes once a second and the timer wheel's hardware timer whenever it was set for. When the state machine
+ * stops the processor the clock jumps to the next of them. The daily diagnostic is made due at the start, and
+ * with no SD card its card check fails.
+ *
+ * usage: idleSim [-n] [-p pass_us] seconds
+ *   -n  never stop the processor, as the main loop did before, for comparison
+ *   -p  microseconds one pass through the state machine takes, 200 if not given
+ *
+ * Build from this directory like seqReplay.c, adding ../CSstateStatusMonitoring.c ../CSidle.c
+ * ../CSdiagnostic.c ../csBasicTelemetry.c and replacing seqReplay.c with idleSim.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "types.h"
+#include "Globals.h"
+#include "CSstateStatusMonitoring.h"
+#include "CSbeacon.h"
+#include "CStimers.h"
+#include "CSidle.h"
+#include "CSevents.h"
+#include "hostMocks.h"
+
+#define SIM_NEVER 0xFFFFFFFFFFFFFFFFull
+
+static uint64_t simNow;       //simulated time, in microseconds
+static uint64_t simTelemetry; //when the telemetry interrupt is next due
+static uint64_t simTimerAt = SIM_NEVER; //when the hardware timer goes off
+static CallbackFunction simTimerCallback;
+static BOOL simNoStop;
+
+static uint64_t simDozing;
+static uint64_t simAwake;
+static uint32_t simWakeups; //times the processor started running again, or main loop passes with -n
+
+void hostEvent(char const* what, uint32_t a, uint32_t b){
+}
+
+void setTimeout(uint32_t ms, CallbackFunction callback, TimerMode mode){
+    simTimerAt = simNow + (uint64_t)ms * 1000;
+    simTimerCallback = callback;
+    G_SET(csState.timerMode, &mode);
+}
+
+/*
+ * simStop
+ * INPUT: uint64_t* counter - where the time stopped is added
+ * OUTPUT: none
+ * INFO: Moves the clock on to the next interrupt.
+ */
+static void simStop(uint64_t* counter){
+    uint64_t next = (simTimerAt < simTelemetry) ? simTimerAt : simTelemetry;
+    if(simNoStop){
+        return;
+    }
+    if(next > simNow){
+        *counter += next - simNow;
+        simNow = next;
+    }
+    simWakeups++;
+}
+
+void Metal_Idle(){
+    simStop(&simDozing);
+}
+
+void powerSavingOff(){
+}
+
+void beaconPowerOn(){
+}
+
+void beaconPowerOff(){
+}
+
+void anomalyChange(){
+    hostEvent("anomaly", 0, 0);
+}
+
+/*
+ * simInterrupts
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Runs every interrupt that is due by now, as the hardware would once the main loop lets it.
+ */
+static void simInterrupts(){
+    while((simTelemetry <= simNow) || (simTimerAt <= simNow)){
+        if(simTimerAt <= simTelemetry){
+            simTimerAt = SIM_NEVER;
+            simTimerCallback();
+        }
+        else{
+            uint32_t epoch = (uint32_t)(simTelemetry / 1000000);
+            hostTime = epoch;
+            G_SET(csLastTelemetry.epoch, &epoch);
+            if(epoch % 8 == 0){
+                eventPush(EVENT_FLUSH_DUE, 0);
+            }
+            eventPush(EVENT_TELEMETRY, 0);
+            simTelemetry += 1000000;
+        }
+    }
+}
+
+int main(int argc, char** argv){
+    StatMonState state = ALL_QUIET;
+    uint8_t diagDay = 0xFF; //not today, so the diagnostic runs
+    idle_stats_t stats;
+    uint64_t end;
+    uint32_t pass = 200;
+    int i;
+    for(i = 1; (i < argc - 1) && (argv[i][0] == '-'); i++){
+        if(strcmp(argv[i], "-n") == 0){
+            simNoStop = true;
+        }
+        else if((strcmp(argv[i], "-p") == 0) && (i + 2 < argc)){
+            pass = atoi(argv[++i]);
+        }
+    }
+    if(i != argc - 1){
+        fprintf(stderr, "usage: %s [-n] [-p pass_us] seconds\n", argv[0]);
+        return 1;
+    }
+    end = (uint64_t)atoi(argv[i]) * 1000000;
+    G_SET(csState.statMonState, &state);
+    G_SET(csState.statMonPrevState, &state);
+    G_SET(csState.diagDay, &diagDay);
+    simTelemetry = 1000000;
+    while(simNow < end){
+        simInterrupts();
+        statusMonitoringStateMachine();
+        simNow += pass;
+        simAwake += pass;
+        if(simNoStop){
+            simWakeups++;
+        }
+    }
+    idleStats(&stats, false);
+    printf("%.1f s simulated\n", simNow / 1e6);
+    printf("dozing %.1f s (%.1f%%), awake %.1f s (%.1f%%)\n",
+           simDozing / 1e6, 100.0 * simDozing / simNow, simAwake / 1e6, 100.0 * simAwake / simNow);
+    printf("%.1f wakeups per second\n", simWakeups / (simNow / 1e6));
+    printf("idleStats: %lu dozes, %lu already due\n", (unsigned long)stats.dozes, (unsigned long)stats.busy);
+    printf("diagnostic: result %02x at %lu s, anomaly %04x\n", Global->csBasicTelemetry.diagResult,
+           (unsigned long)Global->csBasicTelemetry.diagTime, Global->csBasicTelemetry.anomalyModeBasicInfo[0]);
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * File:   seqReplay.c
+ * Author: CSUNSat flight software
+ *
+ * Created on October 18, 2026
+ *
+ * Ground tool that runs command sequences against recorded telemetry before they are uploaded, to see when
+ * each command would run and whether an exit condition would abort the sequence. The flight pendingProcess,
+ * condition, response poll and job code is built for the host with hostMocks.c standing in for the hardware.
+ * Each record of the .TEL day files is handled the way the telemetry path handles a new reading, followed by
+ * handling the events it pushed, which runs pendingProcess, and enough job step events to finish any
+ * background job, so a day of telemetry replays in a few seconds.
+ *
+ * usage: seqReplay [-c programs.bin] [-d index sensor kind window ...] -s slot sequence.bin [...] day.TEL [...]
+ *   -c  condition programs, the code as it would be given to condProgramLoad
+ *   -d  a derived signal, as it would be given to derivedSet
+ *   -s  a sequence_t image for a csSequence slot, loaded as if its upload had ended at the first record
+ *
+ * Each line of the timeline is the epoch, then either what a command handler did or a new response poll item
+ * (the same items the ground would downlink): a command run, a job started or finished, or an abort and the
+ * commands it stopped.
+ *
+ * Build from this directory with the flight include paths and the host compiler, for instance:
+ *   gcc -I. -I.. <flight include dirs> -ffunction-sections -Wl,--gc-sections -o seqReplay seqReplay.c hostMocks.c
+ *       ../CSpendingProcess.c ../CSpendingCommand.c ../CScondition.c ../CScondWatch.c ../CSresponsePoll.c
+ *       ../CSpollLog.c ../CSjobs.c ../CSopcodes.c ../CSderived.c ../CSevents.c ../CSdownlink.c ../CStimerWheel.c
+ * --gc-sections drops the command parser hooks in CSresponsePoll.c, which the replay never calls. The .TEL
+ * records and sequence images are read as the host lays out telemetry_block_t and sequence_t, which matches
+ * the flight layout for little endian hosts that align the same way.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "types.h"
+#include "Globals.h"
+#include "CSlinearBuf.h"
+#include "CSpendingCommand.h"
+#include "CSpendingProcess.h"
+#include "CSresponsePoll.h"
+#include "CSevents.h"
+#include "CScondition.h"
+#include "CScondWatch.h"
+#include "CSderived.h"
+#include "CSjobs.h"
+#include "hostMocks.h"
+
+#define REPLAY_EVENTS 16 //events handled after each second, more than the steps of any job
+
+static sequence_t replaySeq[NUM_SEQUENCES];
+static BOOL replayLoaded[NUM_SEQUENCES];
+static uint16_t replaySeen; //next response poll sequence number to print
+
+/*
+ * hostEvent
+ * INPUT: char const* what - what a mocked handler did
+ *        uint32_t a, uint32_t b - its arguments
+ * OUTPUT: none
+ */
+void hostEvent(char const* what, uint32_t a, uint32_t b){
+    printf("%10lu  %-14s %lu %lu\n", (unsigned long)hostTime, what, (unsigned long)a, (unsigned long)b);
+}
+
+/*
+ * setTimeout
+ * INPUT: uint32_t ms, CallbackFunction callback, TimerMode mode - ignored
+ * OUTPUT: none
+ * INFO: The replay has no timer interrupt, so timer wheel timers never go off.
+ */
+void setTimeout(uint32_t ms, CallbackFunction callback, TimerMode mode){
+}
+
+/*
+ * replayReadFile
+ * INPUT: char const* name - file to read
+ *        void* data - where to put it
+ *        size_t max - room in data
+ * OUTPUT: long - bytes read, or -1 if the file can't be opened
+ */
+static long replayReadFile(char const* name, void* data, size_t max){
+    FILE* file = fopen(name, "rb");
+    long n;
+    if(file == NULL){
+        return -1;
+    }
+    n = fread(data, 1, max, file);
+    fclose(file);
+    return n;
+}
+
+/*
+ * replayUpload
+ * INPUT: uint32_t epoch - time of the first record
+ * OUTPUT: none
+ * INFO: Puts each sequence in its slot and its commands in the response poll as unexecuted pending commands,
+ *       as the command parser would at the end of an upload.
+ */
+static void replayUpload(uint32_t epoch){
+    uint8_t slot;
+    for(slot = 0; slot < NUM_SEQUENCES; slot++){
+        PendCmdQueue queue;
+        seq_command_t cmd;
+        resp_poll_t item;
+        if(!replayLoaded[slot]){
+            continue;
+        }
+        replaySeq[slot].lastCmdTime = epoch;
+        replaySeq[slot].seq_ready_flag = 1;
+        G_SET(csSequence[slot], &replaySeq[slot]);
+        queue = replaySeq[slot].cmd_queue;
+        while(PendCmdQueue_Count(&queue) > 0){
+            PendCmdQueue_Dequeue(&queue, &cmd);
+            item.epoch = epoch;
+            item.cmd_ID = cmd.cmd_id;
+            item.type = PENDING;
+            item.status = 42;
+            item.seqSlot = slot;
+            respPollEnqueue(item);
+        }
+    }
+    replaySeen = Global->csResponsePoll.nextSeq;
+}
+
+/*
+ * replayPrintPoll
+ * INPUT: none
+ * OUTPUT: none
+ * INFO: Prints every item added to the response poll since the last call, then acknowledges them as the
+ *       ground would so the poll never fills up.
+ */
+static void replayPrintPoll(){
+    uint16_t seq;
+    uint8_t i;
+    uint8_t aborting = 0; //bit for each slot whose abort line was just printed
+    for(seq = replaySeen; seq != Global->csResponsePoll.nextSeq; seq++){
+        for(i = 0; i < Global->csResponsePoll.used; i++){
+            resp_poll_t const* item = &Global->csResponsePoll.poll_queue[(Global->csResponsePoll.tail + i) % RESP_POLL_SIZE];
+            char const* what;
+            if((item->seq != seq) || (item->type == RESP_POLL_DELETED)){
+                continue;
+            }
+            if(item->cmd_ID > RESP_POLL_ABORT_ID - NUM_SEQUENCES){
+                what = "ABORT";
+                aborting |= (1 << item->seqSlot);
+            }
+            else if(item->type == PENDING){
+                what = (item->status == JOB_STATUS_RUNNING) ? "job started" : "pending";
+            }
+            else if(aborting & (1 << item->seqSlot)){
+                what = "aborted"; //respPollAbort adds these right after the abort line
+            }
+            else if(item->status == 0){
+                what = "ran";
+            }
+            else{
+                what = "failed";
+            }
+            printf("%10lu  slot %u cmd %5u %-12s status %u\n", (unsigned long)item->epoch, item->seqSlot,
+                   item->cmd_ID, what, item->status);
+            break;
+        }
+    }
+    if(replaySeen != seq){
+        respPollAck(seq - 1);
+    }
+    replaySeen = seq;
+}
+
+/*
+ * replaySecond
+ * INPUT: telemetry_block_t const* block - one recorded second of telemetry
+ * OUTPUT: none
+ * INFO: What handleTelemetryRecording and the status monitoring state machine do with a new reading.
+ */
+static void replaySecond(telemetry_block_t const* block){
+    uint8_t i;
+    hostTime = block->epoch;
+    G_SET(csLastTelemetry.reading, block->readings);
+    G_SET(csLastTelemetry.epoch, &block->epoch);
+    derivedUpdate(Global->csLastTelemetry.reading);
+    condWatchTelemetry(Global->csLastTelemetry.reading);
+    eventPush(EVENT_TELEMETRY, 0);
+    for(i = 0; (i < REPLAY_EVENTS) && eventDispatch(); i++){
+    }
+    replayPrintPoll();
+}
+
+int main(int argc, char** argv){
+    static uint8_t code[COND_PROGRAM_SIZE];
+    uint32_t seconds = 0;
+    BOOL started = false;
+    int i;
+    for(i = 1; i < argc; i++){
+        if((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)){
+            long len = replayReadFile(argv[++i], code, sizeof(code));
+            if((len <= 0) || (condProgramLoad(code, len) != 0)){
+                fprintf(stderr, "%s: not valid condition programs\n", argv[i]);
+                return 1;
+            }
+        }
+        else if((strcmp(argv[i], "-d") == 0) && (i + 4 < argc)){
+            if(derivedSet(atoi(argv[i+1]), atoi(argv[i+2]), atoi(argv[i+3]), atoi(argv[i+4])) != 0){
+                fprintf(stderr, "derived signal %s: not valid\n", argv[i+1]);
+                return 1;
+            }
+            i += 4;
+        }
+        else if((strcmp(argv[i], "-s") == 0) && (i + 2 < argc)){
+            int slot = atoi(argv[++i]);
+            if((slot < 0) || (slot >= NUM_SEQUENCES)
+                    || (replayReadFile(argv[++i], &replaySeq[slot], sizeof(sequence_t)) != sizeof(sequence_t))){
+                fprintf(stderr, "%s: not a sequence for slot %d\n", argv[i], slot);
+                return 1;
+            }
+            replayLoaded[slot] = true;
+        }
+        else{
+            break;
+        }
+    }
+    if(i == argc){
+        fprintf(stderr, "usage: %s [-c programs.bin] [-d index sensor kind window ...] -s slot sequence.bin [...] day.TEL [...]\n",
+                argv[0]);
+        return 1;
+    }
+    for(; i < argc; i++){
+        telemetry_block_t block;
+        FILE* file = fopen(argv[i], "rb");
+        if(file == NULL){
+            fprintf(stderr, "%s: can't open\n", argv[i]);
+            return 1;
+        }
+        while(fread(&block, sizeof(block), 1, file) == 1){
+            if(!started){
+                replayUpload(block.epoch);
+                started = true;
+            }
+            replaySecond(&block);
+            seconds++;
+        }
+        fclose(file);
+    }
+    printf("%lu seconds replayed\n", (unsigned long)seconds);
+    for(i = 0; i < NUM_SEQUENCES; i++){
+        if(replayLoaded[i]){
+            printf("slot %d: %u commands left\n", i, PendCmdQueue_Count(&Global->csSequence[i].cmd_queue));
+        }
+    }
+    return 0;
+}